@@ -0,0 +1,678 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <new>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "../include/point.h"
+#include "../include/figure.h"
+#include "../include/rhombus.h"
+#include "../include/pentagon.h"
+#include "../include/hexagon.h"
+#include "../include/array.h"
+#include "../include/array_of_figures.h"
+#include "../include/array_sort.h"
+#include "../include/small_array.h"
+#include "../include/figure_bounds.h"
+#include "../include/cow_array.h"
+#include "../include/memory_footprint.h"
+#include "../include/figure_aggregator.h"
+#include "../include/figure_codec.h"
+#include "../include/robust_predicates.h"
+#include "../include/shared_figures.h"
+#include "../include/numa.h"
+#include "../include/figure_batch.h"
+#include "../include/figure_raster.h"
+#include "../include/figure_pool.h"
+#include "../include/figure_join.h"
+
+using FigureArray = Array<std::shared_ptr<Figure<double>>>;
+
+// Счётчик выделений памяти для сравнения аллокаций между вариантами
+static std::atomic<size_t> allocationCount{0};
+
+// Замещающие operator new/delete ходят в malloc/free только через эти
+// функции: без встраивания компилятор не видит free() на указателе из
+// operator new и не выдаёт -Wmismatched-new-delete
+__attribute__((noinline)) static void* countedAllocate(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) static void countedRelease(void* p) noexcept {
+    std::free(p);
+}
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t) noexcept { countedRelease(p); }
+
+template<class F>
+double measureMs(F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+static FigureArray makeRandomFigures(size_t n, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    std::uniform_real_distribution<double> radius(0.1, 10.0);
+
+    FigureArray figures;
+    figures.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        Point<double> c(coord(rng), coord(rng));
+        double r = radius(rng);
+        switch (i % 3) {
+        case 0:
+            figures.push_back(std::make_shared<Rhombus<double>>(
+                Point<double>(c.getX(), c.getY() + r), Point<double>(c.getX() + r / 2, c.getY()),
+                Point<double>(c.getX(), c.getY() - r), Point<double>(c.getX() - r / 2, c.getY())));
+            break;
+        case 1:
+            figures.push_back(std::make_shared<Pentagon<double>>(c, r));
+            break;
+        default:
+            figures.push_back(std::make_shared<Hexagon<double>>(c, r));
+            break;
+        }
+    }
+    return figures;
+}
+
+// Сортировка по площади: компаратор с виртуальным area() против предвычисленных ключей
+static void benchSort(size_t n) {
+    FigureArray base = makeRandomFigures(n);
+
+    FigureArray a = base;
+    double comparatorMs = measureMs([&]() {
+        std::sort(a.begin(), a.end(), [](const auto& l, const auto& r) {
+            return l->area() < r->area();
+        });
+    });
+
+    FigureArray b = base;
+    double keyedMs = measureMs([&]() { sortByArea(b); });
+
+    FigureArray c = base;
+    double partialMs = measureMs([&]() { partialSortByArea(c, 1000, true); });
+
+    FigureArray top;
+    double topMs = measureMs([&]() { top = topKByArea(base, 1000); });
+
+    std::cout << "n = " << n << "\n"
+              << "std::sort with area() comparator: " << comparatorMs << " ms\n"
+              << "sortByArea (precomputed keys):     " << keyedMs << " ms\n"
+              << "partialSortByArea, k = 1000:       " << partialMs << " ms\n"
+              << "topKByArea, k = 1000:              " << topMs << " ms\n";
+}
+
+template<class Collection>
+static double smallCollectionsPass(const FigureArray& pool, size_t n, size_t& allocations) {
+    size_t before = allocationCount.load();
+    double checksum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Collection collection;
+        size_t count = 1 + i % 8;
+        for (size_t j = 0; j < count; ++j) {
+            collection.push_back(pool[(i + j) % pool.size()]);
+        }
+        for (const auto& figure : collection) {
+            checksum += figure->area();
+        }
+    }
+    allocations = allocationCount.load() - before;
+    return checksum;
+}
+
+// Миллионы короткоживущих коллекций из 1..8 фигур: Array против SmallArray<.., 8>
+static void benchSmallArray(size_t n) {
+    FigureArray pool = makeRandomFigures(1024);
+    size_t heapAllocs = 0, inlineAllocs = 0;
+    double heapSum = 0, inlineSum = 0;
+
+    double heapMs = measureMs([&]() {
+        heapSum = smallCollectionsPass<FigureArray>(pool, n, heapAllocs);
+    });
+    double inlineMs = measureMs([&]() {
+        inlineSum = smallCollectionsPass<SmallArray<std::shared_ptr<Figure<double>>, 8>>(pool, n, inlineAllocs);
+    });
+
+    std::cout << "collections = " << n << " (checksums " << heapSum << " / " << inlineSum << ")\n"
+              << "Array:          " << heapMs << " ms, " << heapAllocs << " allocations\n"
+              << "SmallArray<8>:  " << inlineMs << " ms, " << inlineAllocs << " allocations\n";
+}
+
+// Ограничивающий прямоугольник, выпуклая оболочка и минимальная окружность по n вершинам
+static void benchHull(size_t n) {
+    FigureArray figures = makeRandomFigures(n / 5);
+    std::vector<Point<double>> vertices;
+    double collectMs = measureMs([&]() { vertices = collectVertices(figures); });
+
+    BoundingBox<double> box;
+    double boxMs = measureMs([&]() { box = boundingBox(vertices); });
+
+    std::vector<Point<double>> hull;
+    double hullMs = measureMs([&]() { hull = convexHull(vertices); });
+
+    Circle circle;
+    double circleMs = measureMs([&]() { circle = minimumEnclosingCircle(hull); });
+
+    std::cout << "vertices = " << vertices.size() << "\n"
+              << "collectVertices:        " << collectMs << " ms\n"
+              << "boundingBox:            " << boxMs << " ms (" << box.width() << " x " << box.height() << ")\n"
+              << "convexHull:             " << hullMs << " ms (" << hull.size() << " points)\n"
+              << "minimumEnclosingCircle: " << circleMs << " ms (r = " << circle.radius << ")\n";
+}
+
+// Снимки коллекции: глубокая копия Array против CowArray, запись после снимка и обход
+static void benchSnapshot(size_t n) {
+    FigureArray figures = makeRandomFigures(n);
+    CowArray<std::shared_ptr<Figure<double>>> cow(figures);
+
+    FigureArray copy;
+    double copyMs = measureMs([&]() { copy = figures; });
+
+    CowArray<std::shared_ptr<Figure<double>>> snapshot;
+    double snapshotMs = measureMs([&]() { snapshot = cow.snapshot(); });
+
+    auto replacement = std::make_shared<Hexagon<double>>(Point<double>(0, 0), 1.0);
+    double writeMs = measureMs([&]() {
+        for (size_t i = 0; i < 1000; ++i) {
+            cow.set((i * 7919) % n, replacement);
+        }
+    });
+
+    double arraySum = 0, cowSum = 0;
+    double arrayIterMs = measureMs([&]() { arraySum = totalArea(figures); });
+    double cowIterMs = measureMs([&]() { cowSum = totalArea(snapshot); });
+
+    std::cout << "n = " << n << "\n"
+              << "Array copy:                 " << copyMs << " ms\n"
+              << "CowArray snapshot:          " << snapshotMs << " ms\n"
+              << "1000 writes after snapshot: " << writeMs << " ms (" << cow.sharedChunks(snapshot)
+              << " of " << cow.chunkCount() << " chunks still shared)\n"
+              << "totalArea Array:            " << arrayIterMs << " ms (" << arraySum << ")\n"
+              << "totalArea CowArray:         " << cowIterMs << " ms (" << cowSum << ")\n";
+}
+
+// Разбивка памяти коллекции и выигрыш от compact()
+static void benchFootprint(size_t n) {
+    FigureArray figures = makeRandomFigures(n);
+    MemoryFootprint footprint = memoryFootprint(figures);
+
+    CompactReport report;
+    FigureBuffer<double> buffer;
+    double compactMs = measureMs([&]() { buffer = compact(figures, &report); });
+
+    std::cout << "n = " << n << "\n"
+              << footprint << "\n"
+              << "bytes per figure: " << footprint.bytesPerFigure() << "\n"
+              << "compact: " << compactMs << " ms, " << report << "\n"
+              << "compact bytes per figure: " << static_cast<double>(report.bytesAfter) / n << "\n";
+}
+
+// Поток событий вставки/удаления/изменения: инкрементальные агрегаты против пересчёта totalArea
+static void benchAggregator(size_t n) {
+    FigureArray figures = makeRandomFigures(n);
+    FigureAggregator aggregator;
+    double insertMs = measureMs([&]() {
+        for (size_t i = 0; i < n; ++i) {
+            aggregator.insert(i, *figures[i]);
+        }
+    });
+
+    const size_t events = 100000;
+    double eventsMs = measureMs([&]() {
+        for (size_t e = 0; e < events; ++e) {
+            size_t id = (e * 7919) % n;
+            if (e % 2 == 0) {
+                aggregator.update(id, *figures[(id + 1) % n]);
+            } else {
+                aggregator.erase(id);
+                aggregator.insert(id, *figures[id]);
+            }
+        }
+    });
+
+    double recomputeMs = measureMs([&]() { totalArea(figures); });
+    ReconcileReport report;
+    double reconcileMs = measureMs([&]() { report = aggregator.reconcile(); });
+
+    std::cout << "n = " << n << "\n"
+              << "initial inserts:          " << insertMs << " ms\n"
+              << events << " events:            " << eventsMs << " ms (" << eventsMs * 1e6 / events << " ns/event)\n"
+              << "one full totalArea pass:  " << recomputeMs << " ms\n"
+              << "reconcile:                " << reconcileMs << " ms, drift " << report.areaDrift << "\n";
+}
+
+// Сжатый колоночный формат против текстового (число вершин и координаты, чтение через read())
+static void benchCodec(size_t n) {
+    FigureArray figures = makeRandomFigures(n);
+    FigureBuffer<double> buffer(figures);
+    double rawBytes = static_cast<double>(buffer.coordCount() * sizeof(double));
+
+    std::string text;
+    double textWriteMs = measureMs([&]() {
+        std::ostringstream os;
+        os.precision(17);
+        for (const auto& figure : figures) {
+            os << figure->vertexCount();
+            for (size_t v = 0; v < figure->vertexCount(); ++v) {
+                os << ' ' << figure->getVertex(v).getX() << ' ' << figure->getVertex(v).getY();
+            }
+            os << '\n';
+        }
+        text = os.str();
+    });
+
+    FigureArray parsed;
+    double textReadMs = measureMs([&]() {
+        std::istringstream is(text);
+        size_t vertices;
+        while (is >> vertices) {
+            std::shared_ptr<Figure<double>> figure;
+            if (vertices == 4) figure = std::make_shared<Rhombus<double>>();
+            else if (vertices == 5) figure = std::make_shared<Pentagon<double>>();
+            else figure = std::make_shared<Hexagon<double>>();
+            is >> *figure;
+            parsed.push_back(figure);
+        }
+    });
+
+    std::vector<uint8_t> encoded;
+    double encodeMs = measureMs([&]() { encoded = encodeFigures(buffer); });
+    FigureBuffer<double> decoded;
+    double decodeMs = measureMs([&]() { decoded = decodeFigures<double>(encoded); });
+    FigureArray decodedArray;
+    double toArrayMs = measureMs([&]() { decodedArray = decoded.toArray(); });
+
+    std::cout << "n = " << n << ", raw vertex data " << rawBytes / 1e6 << " MB\n"
+              << "text:   " << text.size() / 1e6 << " MB, write " << textWriteMs << " ms, parse "
+              << textReadMs << " ms (" << rawBytes / textReadMs / 1e6 << " GB/s)\n"
+              << "binary: " << encoded.size() / 1e6 << " MB (ratio x" << rawBytes / encoded.size()
+              << "), encode " << encodeMs << " ms, decode " << decodeMs << " ms ("
+              << rawBytes / decodeMs / 1e6 << " GB/s), to Array " << toArrayMs << " ms\n";
+}
+
+// Стоимость устойчивой ориентации и площади по сравнению с наивной формулой в double
+static void benchRobust(size_t n) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    std::vector<Point<double>> points(n + 2);
+    for (auto& p : points) {
+        p = Point<double>(coord(rng), coord(rng));
+    }
+    // Каждая сотая тройка почти коллинеарна
+    for (size_t i = 0; i + 2 < points.size(); i += 100) {
+        double t = std::uniform_real_distribution<double>(0, 1)(rng);
+        points[i + 2] = Point<double>(points[i].getX() + t * (points[i + 1].getX() - points[i].getX()),
+                                      points[i].getY() + t * (points[i + 1].getY() - points[i].getY()));
+    }
+
+    long naiveSum = 0, robustSum = 0;
+    size_t filtered = 0;
+    double naiveMs = measureMs([&]() {
+        for (size_t i = 0; i < n; ++i) {
+            double d = orient2dFast(points[i], points[i + 1], points[i + 2]);
+            naiveSum += d > 0 ? 1 : (d < 0 ? -1 : 0);
+        }
+    });
+    double robustMs = measureMs([&]() {
+        for (size_t i = 0; i < n; ++i) {
+            robustSum += orient2d(points[i], points[i + 1], points[i + 2]);
+        }
+    });
+    for (size_t i = 0; i < n; ++i) {
+        filtered += orient2dFilterDecides(points[i], points[i + 1], points[i + 2]);
+    }
+
+    FigureArray figures = makeRandomFigures(n / 10);
+    double areaSum = 0, robustAreaSum = 0;
+    double areaMs = measureMs([&]() { areaSum = totalArea(figures); });
+    double robustAreaMs = measureMs([&]() {
+        for (const auto& figure : figures) {
+            robustAreaSum += robustArea(*figure);
+        }
+    });
+
+    std::cout << "orient2d, n = " << n << "\n"
+              << "naive:    " << naiveMs << " ms (sum " << naiveSum << ")\n"
+              << "adaptive: " << robustMs << " ms (sum " << robustSum << "), fast path "
+              << 100.0 * filtered / n << "%\n"
+              << "area, n = " << figures.size() << "\n"
+              << "area():       " << areaMs << " ms (" << areaSum << ")\n"
+              << "robustArea(): " << robustAreaMs << " ms (" << robustAreaSum << ")\n";
+}
+
+// Построение из текста: по объекту через read() против пакетного чтения с проверкой
+static void benchBatch(size_t n) {
+    FigureArray source = makeRandomFigures(n);
+    std::ostringstream text;
+    text.precision(17);
+    for (const auto& figure : source) {
+        text << figure->vertexCount();
+        for (size_t v = 0; v < figure->vertexCount(); ++v) {
+            text << " " << figure->getVertex(v).getX() << " " << figure->getVertex(v).getY();
+        }
+        text << "\n";
+    }
+    std::string input = text.str();
+
+    FigureArray perObject;
+    double perObjectMs = measureMs([&]() {
+        std::istringstream is(input);
+        size_t vertices;
+        while (is >> vertices) {
+            std::shared_ptr<Figure<double>> figure;
+            if (vertices == 4) figure = std::make_shared<Rhombus<double>>();
+            else if (vertices == 5) figure = std::make_shared<Pentagon<double>>();
+            else figure = std::make_shared<Hexagon<double>>();
+            is >> *figure;
+            perObject.push_back(figure);
+        }
+    });
+
+    std::vector<FigureKind> kinds;
+    std::vector<double> coords;
+    double parseMs = measureMs([&]() {
+        std::istringstream is(input);
+        readFigureBatch(is, kinds, coords);
+    });
+    FigureBatchErrors errors;
+    double validateMs = measureMs([&]() {
+        errors = validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size());
+    });
+    FigureArray batch;
+    double buildMs = measureMs([&]() { batch = buildFigures(kinds, coords, errors); });
+    FigureBuffer<double> buffer;
+    double bufferMs = measureMs([&]() {
+        buffer = buildFigureBuffer(kinds.data(), kinds.size(), coords.data(), coords.size(), errors);
+    });
+
+    std::cout << "n = " << n << "\n"
+              << "read() per object:       " << perObjectMs << " ms, no validation\n"
+              << "readFigureBatch:         " << parseMs << " ms\n"
+              << "validateFigures:         " << validateMs << " ms, rejected " << errors.invalidCount() << "\n"
+              << "buildFigures:            " << buildMs << " ms (" << batch.size() << " figures)\n"
+              << "buildFigureBuffer:       " << bufferMs << " ms (" << buffer.size() << " figures)\n";
+}
+
+// Покрытие: наивная проверка центра каждой ячейки по каждой фигуре против
+// растеризации по плиткам; затем n фигур на сетку 16384 x 16384
+static void benchRaster(size_t n) {
+    const size_t side = 16384;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(0.0, static_cast<double>(side));
+    std::uniform_real_distribution<double> radius(0.5, 8.0);
+    std::uniform_real_distribution<double> angle(0.0, 2 * M_PI);
+
+    FigureBuffer<double> buffer;
+    buffer.reserve(n, 10 * n);
+    double xy[12];
+    for (size_t i = 0; i < n; ++i) {
+        FigureKind kind = static_cast<FigureKind>(4 + i % 3);
+        size_t vertices = vertexCountOf(kind);
+        double cx = coord(rng), cy = coord(rng), r = radius(rng), a = angle(rng);
+        for (size_t v = 0; v < vertices; ++v) {
+            xy[2 * v] = cx + r * std::cos(a + 2 * M_PI * v / vertices);
+            xy[2 * v + 1] = cy + r * std::sin(a + 2 * M_PI * v / vertices);
+        }
+        buffer.push_back(kind, xy);
+    }
+
+    // Наивный вариант на уменьшенной задаче: 256 x 256 ячеек и 2000 фигур
+    GridSpec small;
+    small.cellSize = static_cast<double>(side) / 256;
+    small.width = small.height = 256;
+    FigureBuffer<double> sample;
+    for (size_t i = 0; i < std::min<size_t>(2000, n); ++i) {
+        sample.push_back(buffer.kind(i), buffer.vertices(i));
+    }
+    double naiveHits = 0;
+    double naiveMs = measureMs([&]() {
+        for (size_t y = 0; y < small.height; ++y) {
+            for (size_t x = 0; x < small.width; ++x) {
+                double px = (x + 0.5) * small.cellSize, py = (y + 0.5) * small.cellSize;
+                sample.forEach(0, sample.size(), [&](size_t, FigureKind kind, const double* p) {
+                    size_t count = vertexCountOf(kind);
+                    bool inside = true;
+                    for (size_t v = 0; v < count && inside; ++v) {
+                        size_t w = (v + 1) % count;
+                        inside = (p[2 * w] - p[2 * v]) * (py - p[2 * v + 1]) -
+                                 (p[2 * w + 1] - p[2 * v + 1]) * (px - p[2 * v]) >= 0;
+                    }
+                    naiveHits += inside;
+                });
+            }
+        }
+    });
+    CoverageGrid smallGrid(small);
+    double smallMs = measureMs([&]() { rasterize(sample, smallGrid, RasterMode::Binary); });
+    std::cout << "256 x 256, 2000 figures: naive " << naiveMs << " ms (" << naiveHits << " hits), tiled binary "
+              << smallMs << " ms (" << smallGrid.total() << ")\n";
+
+    GridSpec spec;
+    spec.width = spec.height = side;
+    for (RasterMode mode : {RasterMode::AntiAliased, RasterMode::Binary}) {
+        CoverageGrid grid(spec);
+        double ms = measureMs([&]() { rasterize(buffer, grid, mode); });
+        std::cout << side << " x " << side << ", n = " << n
+                  << (mode == RasterMode::AntiAliased ? ", anti-aliased: " : ", binary:       ") << ms
+                  << " ms, coverage " << grid.total() << " (area " << buffer.totalArea() << "), tiles "
+                  << grid.allocatedTiles() << "/" << grid.tileCount() << "\n";
+    }
+}
+
+// Создание и удаление фигур в 1..64 потоках: make_shared против пула.
+// Каждый раунд поток удаляет фигуры соседа из прошлого раунда (передача
+// между потоками) и создаёт свои; всего n фигур на каждое число потоков.
+static void benchPool(size_t n) {
+    const size_t rounds = 8;
+    auto run = [&](size_t threads, auto make) {
+        std::vector<std::vector<std::shared_ptr<Figure<double>>>> slots[2];
+        slots[0].resize(threads);
+        slots[1].resize(threads);
+        size_t perThread = std::max<size_t>(1, n / (threads * rounds));
+        return measureMs([&]() {
+            for (size_t round = 0; round < rounds; ++round) {
+                std::vector<std::thread> workers;
+                for (size_t t = 0; t < threads; ++t) {
+                    workers.emplace_back([&, t, round]() {
+                        slots[(round + 1) % 2][(t + 1) % threads].clear();
+                        auto& mine = slots[round % 2][t];
+                        mine.reserve(perThread);
+                        for (size_t i = 0; i < perThread; ++i) {
+                            double x = static_cast<double>(i);
+                            mine.push_back(make(Point<double>(x, 0), Point<double>(x + 1, 0), Point<double>(x + 2, 1),
+                                                Point<double>(x + 1, 2), Point<double>(x, 2), Point<double>(x - 1, 1)));
+                        }
+                    });
+                }
+                for (auto& worker : workers) worker.join();
+            }
+        });
+    };
+    auto plain = [](const auto&... p) -> std::shared_ptr<Figure<double>> {
+        return std::make_shared<Hexagon<double>>(p...);
+    };
+    auto pooled = [](const auto&... p) -> std::shared_ptr<Figure<double>> {
+        return FigurePool<Hexagon<double>>::instance().make(p...);
+    };
+
+    std::cout << "n = " << n << " hexagons per thread count, " << std::thread::hardware_concurrency() << " cpus\n"
+              << "threads  make_shared ms  pool ms  allocations (make_shared / pool)\n";
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        size_t allocationsBefore = allocationCount.load();
+        double plainMs = run(threads, plain);
+        size_t plainAllocations = allocationCount.load() - allocationsBefore;
+        allocationsBefore = allocationCount.load();
+        double poolMs = run(threads, pooled);
+        size_t poolAllocations = allocationCount.load() - allocationsBefore;
+        std::cout << threads << "\t " << plainMs << "\t " << poolMs << "\t " << plainAllocations << " / "
+                  << poolAllocations << "\n";
+    }
+}
+
+// Ближайший центр другого набора: вложенные циклы по geometricCenter()
+// против k-d дерева; затем n x n на упакованных буферах
+static void benchJoin(size_t n) {
+    auto makeBuffer = [](size_t count, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> coord(-1000000.0, 1000000.0);
+        std::uniform_real_distribution<double> radius(0.1, 10.0);
+        FigureBuffer<double> buffer;
+        buffer.reserve(count, 10 * count);
+        double xy[12];
+        for (size_t i = 0; i < count; ++i) {
+            FigureKind kind = static_cast<FigureKind>(4 + i % 3);
+            size_t vertices = vertexCountOf(kind);
+            double cx = coord(rng), cy = coord(rng), r = radius(rng);
+            for (size_t v = 0; v < vertices; ++v) {
+                xy[2 * v] = cx + r * std::cos(2 * M_PI * v / vertices);
+                xy[2 * v + 1] = cy + r * std::sin(2 * M_PI * v / vertices);
+            }
+            buffer.push_back(kind, xy);
+        }
+        return buffer;
+    };
+
+    // Наивный вариант на уменьшенной задаче
+    const size_t small = std::min<size_t>(5000, n);
+    FigureArray rhombi = makeRandomFigures(small, 1), hexagons = makeRandomFigures(small, 2);
+    std::vector<IndexPair> naive(small);
+    double naiveMs = measureMs([&]() {
+        for (size_t i = 0; i < small; ++i) {
+            double best = std::numeric_limits<double>::infinity();
+            for (size_t j = 0; j < small; ++j) {
+                Point<double> a = rhombi[i]->geometricCenter(), b = hexagons[j]->geometricCenter();
+                double dx = a.getX() - b.getX(), dy = a.getY() - b.getY();
+                if (dx * dx + dy * dy < best) {
+                    best = dx * dx + dy * dy;
+                    naive[i] = {static_cast<uint32_t>(i), static_cast<uint32_t>(j)};
+                }
+            }
+        }
+    });
+    std::vector<IndexPair> joined;
+    double joinMs = measureMs([&]() { joined = knnJoin(rhombi, hexagons, 1); });
+    std::cout << small << " x " << small << ": nested loops " << naiveMs << " ms, k-d join " << joinMs
+              << " ms, same result: " << (naive == joined ? "yes" : "no") << "\n";
+
+    FigureBuffer<double> left = makeBuffer(n, 3), right = makeBuffer(n, 4);
+    std::cout << n << " x " << n << ", " << std::thread::hardware_concurrency() << " cpus\n";
+    CentroidSet leftCenters, rightCenters;
+    double centerMs = measureMs([&]() {
+        leftCenters = centroids(left);
+        rightCenters = centroids(right);
+    });
+    CentroidTree tree;
+    double buildMs = measureMs([&]() { tree = CentroidTree(rightCenters); });
+    std::cout << "centroids: " << centerMs << " ms, tree build: " << buildMs << " ms (" << tree.leafCount()
+              << " leaves)\n";
+    for (size_t k : {size_t(1), size_t(4)}) {
+        std::vector<IndexPair> pairs;
+        double ms = measureMs([&]() { pairs = knnJoin(leftCenters, tree, k); });
+        std::cout << "knn k = " << k << ": " << ms << " ms, " << pairs.size() << " pairs\n";
+    }
+    std::vector<IndexPair> pairs;
+    double radiusMs = measureMs([&]() { pairs = radiusJoin(leftCenters, tree, 500.0); });
+    std::cout << "within 500: " << radiusMs << " ms, " << pairs.size() << " pairs\n";
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Агрегаты по области shared memory в 1, 2, 4, ... процессах
+static void benchShards(size_t n) {
+    FigureBuffer<double> buffer(makeRandomFigures(n));
+    std::string name = "/lab4_bench_" + std::to_string(getpid());
+    auto region = SharedFigureRegion<double>::create(name, buffer, 64);
+
+    double single = 0;
+    double singleMs = measureMs([&]() { single = buffer.totalArea(); });
+    std::cout << "n = " << n << ", in-process totalArea: " << singleMs << " ms (" << single << ")\n";
+    for (size_t workers = 1; workers <= 16; workers *= 2) {
+        ShardedAggregate aggregate;
+        double ms = measureMs([&]() { aggregate = shardedAggregate(region, workers); });
+        std::cout << workers << " processes: " << ms << " ms (" << aggregate.totalArea << ")\n";
+    }
+}
+#endif
+
+#ifdef __linux__
+// Площадь по узлам: каждый узел читает свою часть (локально) или часть
+// соседнего узла (удалённо); на машине с одним узлом времена совпадают
+static void benchNuma(size_t n) {
+    FigureBuffer<double> buffer(makeRandomFigures(n));
+    NumaTopology topology = NumaTopology::detect();
+    NumaFigureBuffer<double> placed(buffer, topology);
+    NumaExecutor executor(topology);
+    std::cout << "n = " << n << ", nodes = " << topology.nodeCount() << "\n";
+    for (size_t node = 0; node < topology.nodeCount(); ++node) {
+        auto range = placed.nodeRanges()[node];
+        std::cout << "node " << node << ": " << topology.nodeCpus[node].size() << " cpus, figures ["
+                  << range.first << ", " << range.second << "), first page on node "
+                  << pageNode(placed.coordData() + buffer.coordOffset(range.first)) << "\n";
+    }
+
+    double plain = 0;
+    double plainMs = measureMs([&]() { plain = buffer.totalArea(); });
+    std::cout << "parallelFor:  " << plainMs << " ms (" << plain << ")\n";
+    for (size_t shift : {size_t(0), size_t(1)}) {
+        NumaRunStats stats;
+        double total = 0;
+        double ms = measureMs([&]() { total = placed.totalArea(executor, &stats, shift); });
+        std::cout << (shift == 0 ? "local:        " : "remote:       ") << ms << " ms (" << total
+                  << "), chunks local " << stats.localChunks << " remote " << stats.remoteChunks << "\n";
+    }
+}
+#endif
+
+int main(int argc, char** argv) {
+    const std::map<std::string, std::pair<std::function<void(size_t)>, size_t>> benches = {
+        {"sort", {benchSort, 1000000}},
+        {"small_array", {benchSmallArray, 5000000}},
+        {"hull", {benchHull, 10000000}},
+        {"snapshot", {benchSnapshot, 2000000}},
+        {"footprint", {benchFootprint, 1000000}},
+        {"aggregator", {benchAggregator, 1000000}},
+        {"codec", {benchCodec, 1000000}},
+        {"robust", {benchRobust, 10000000}},
+        {"batch", {benchBatch, 1000000}},
+        {"raster", {benchRaster, 10000000}},
+        {"pool", {benchPool, 4000000}},
+        {"join", {benchJoin, 10000000}},
+#if defined(__unix__) || defined(__APPLE__)
+        {"shards", {benchShards, 2000000}},
+#endif
+#ifdef __linux__
+        {"numa", {benchNuma, 2000000}},
+#endif
+    };
+
+    if (argc < 2 || benches.find(argv[1]) == benches.end()) {
+        std::cerr << "Usage: bench <name> [n]\nAvailable:";
+        for (const auto& entry : benches) {
+            std::cerr << " " << entry.first;
+        }
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    const auto& bench = benches.at(argv[1]);
+    size_t n = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : bench.second;
+    bench.first(n);
+    return 0;
+}
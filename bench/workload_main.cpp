@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../include/figure_workload.h"
+#include "../include/array_of_figures.h"
+#include "../include/array_sort.h"
+#include "../include/figure_buffer.h"
+
+// Представительная нагрузка для PGO и perf stat. Каждая фаза нагружает одну
+// горячую функцию, поэтому запуск одной фазы даёт счётчики именно для неё.
+// Вывод: phase,ms,checksum — по строке на фазу.
+
+using FigureArray = Array<std::shared_ptr<Figure<double>>>;
+
+template<class F>
+static double measureMs(F fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::string only = argc > 1 ? argv[1] : "all";
+    WorkloadConfig config;
+    if (argc > 2) config.figures = std::strtoull(argv[2], nullptr, 10);
+    size_t iterations = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10;
+
+    FigureArray figures = generateFigures<double>(config);
+    FigureBuffer<double> buffer(figures);
+
+    // Виртуальный вызов area() для каждой фигуры
+    auto area = [&]() {
+        double sum = 0;
+        for (size_t it = 0; it < iterations; ++it) {
+            for (const auto& figure : figures) {
+                sum += figure->area();
+            }
+        }
+        return sum;
+    };
+    auto total = [&]() {
+        double sum = 0;
+        for (size_t it = 0; it < iterations; ++it) {
+            sum += totalArea(figures);
+        }
+        return sum;
+    };
+    // Рост массива с нуля: повторные Array::resize и перенос элементов
+    auto resize = [&]() {
+        double sum = 0;
+        for (size_t it = 0; it < iterations; ++it) {
+            FigureArray grown;
+            for (const auto& figure : figures) {
+                grown.push_back(figure);
+            }
+            sum += static_cast<double>(grown.size());
+        }
+        return sum;
+    };
+    auto packed = [&]() {
+        double sum = 0;
+        for (size_t it = 0; it < iterations; ++it) {
+            sum += buffer.totalArea();
+        }
+        return sum;
+    };
+    auto sort = [&]() {
+        FigureArray copy = figures;
+        sortByArea(copy);
+        return copy[0]->area();
+    };
+
+    const std::vector<std::pair<std::string, std::function<double()>>> phases = {
+        {"area", area}, {"totalArea", total}, {"resize", resize}, {"buffer", packed}, {"sort", sort},
+    };
+
+    bool found = false;
+    std::cout << "phase,ms,checksum\n";
+    for (const auto& phase : phases) {
+        if (only != "all" && only != phase.first) continue;
+        found = true;
+        double checksum = 0;
+        double ms = measureMs([&]() { checksum = phase.second(); });
+        std::cout << phase.first << "," << ms << "," << checksum << "\n";
+    }
+    if (!found) {
+        std::cerr << "Usage: workload [all|area|totalArea|resize|buffer|sort] [figures] [iterations]" << std::endl;
+        return 1;
+    }
+    return 0;
+}
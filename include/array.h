@@ -94,6 +94,23 @@ public:
     
     size_t size() const { return size_; }
     size_t capacity() const { return capacity_; }
+
+    void reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            resize(new_capacity);
+        }
+    }
+
+    void shrink_to_fit() {
+        if (size_ < capacity_) {
+            resize(size_);
+        }
+    }
+
+    T* begin() { return data.get(); }
+    T* end() { return data.get() + size_; }
+    const T* begin() const { return data.get(); }
+    const T* end() const { return data.get() + size_; }
     
     bool empty() const { return size_ == 0; }
     
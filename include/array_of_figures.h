@@ -1,5 +1,6 @@
 #pragma once
 #include "array.h"
+#include "cow_array.h"
 #include "figure.h"
 #include <iostream>
 
@@ -22,3 +23,12 @@ double totalArea(const Array<std::shared_ptr<Figure<T>>>& array) {
     }
     return total;
 }
+
+template<class T, size_t ChunkSize>
+double totalArea(const CowArray<std::shared_ptr<Figure<T>>, ChunkSize>& array) {
+    double total = 0;
+    array.forEach([&](const std::shared_ptr<Figure<T>>& figure) {
+        total += static_cast<double>(*figure);
+    });
+    return total;
+}
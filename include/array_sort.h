@@ -0,0 +1,174 @@
+#pragma once
+#include "array.h"
+#include "figure.h"
+#include "parallel.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Ключ сортировки вычисляется один раз на элемент; при равных ключах
+// сохраняется исходный порядок (сравнение по индексу).
+struct SortKey {
+    double key;
+    size_t index;
+
+    bool operator<(const SortKey& other) const {
+        return key < other.key || (key == other.key && index < other.index);
+    }
+};
+
+template<class T, class KeyFn>
+std::vector<SortKey> extractKeys(const Array<T>& array, KeyFn keyFn, bool descending = false) {
+    std::vector<SortKey> keys(array.size());
+    const T* items = array.begin();
+    parallelFor(array.size(), [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            double key = keyFn(items[i]);
+            keys[i] = {descending ? -key : key, i};
+        }
+    });
+    return keys;
+}
+
+// Параллельная сортировка слиянием: блоки сортируются независимо,
+// затем попарно сливаются до одного блока.
+inline void parallelSortKeys(std::vector<SortKey>& keys) {
+    const size_t minChunk = 1 << 16;
+    size_t n = keys.size();
+    size_t workers = workerCount(n, minChunk);
+    if (workers <= 1) {
+        std::sort(keys.begin(), keys.end());
+        return;
+    }
+
+    size_t chunk = (n + workers - 1) / workers;
+    parallelFor(n, [&](size_t begin, size_t end, size_t) {
+        std::sort(keys.begin() + begin, keys.begin() + end);
+    }, minChunk);
+
+    std::vector<SortKey> buffer(n);
+    std::vector<SortKey>* src = &keys;
+    std::vector<SortKey>* dst = &buffer;
+    for (size_t width = chunk; width < n; width *= 2) {
+        size_t pairs = (n + 2 * width - 1) / (2 * width);
+        parallelFor(pairs, [&](size_t pbegin, size_t pend, size_t) {
+            for (size_t p = pbegin; p < pend; ++p) {
+                size_t lo = p * 2 * width;
+                size_t mid = std::min(n, lo + width);
+                size_t hi = std::min(n, lo + 2 * width);
+                std::merge(src->begin() + lo, src->begin() + mid,
+                           src->begin() + mid, src->begin() + hi,
+                           dst->begin() + lo);
+            }
+        }, 1);
+        std::swap(src, dst);
+    }
+    if (src != &keys) {
+        keys.swap(buffer);
+    }
+}
+
+// Первые k наименьших ключей в порядке возрастания. Каждый поток отбирает
+// своих k кандидатов, итог выбирается из объединения кандидатов.
+inline std::vector<SortKey> selectSmallestKeys(const std::vector<SortKey>& keys, size_t k) {
+    size_t n = keys.size();
+    k = std::min(k, n);
+    const size_t minChunk = 1 << 16;
+    size_t workers = workerCount(n, minChunk);
+
+    std::vector<std::vector<SortKey>> candidates(workers);
+    parallelFor(n, [&](size_t begin, size_t end, size_t w) {
+        std::vector<SortKey> local(keys.begin() + begin, keys.begin() + end);
+        if (local.size() > k) {
+            std::nth_element(local.begin(), local.begin() + k, local.end());
+            local.resize(k);
+        }
+        candidates[w] = std::move(local);
+    }, minChunk);
+
+    std::vector<SortKey> merged;
+    for (auto& c : candidates) {
+        merged.insert(merged.end(), c.begin(), c.end());
+    }
+    std::partial_sort(merged.begin(), merged.begin() + k, merged.end());
+    merged.resize(k);
+    return merged;
+}
+
+template<class T>
+void permuteArray(Array<T>& array, const std::vector<SortKey>& order) {
+    Array<T> result;
+    result.reserve(array.capacity());
+    T* items = array.begin();
+    for (const auto& entry : order) {
+        result.push_back(std::move(items[entry.index]));
+    }
+    array = std::move(result);
+}
+
+template<class T, class KeyFn>
+void sortByKey(Array<T>& array, KeyFn keyFn, bool descending = false) {
+    auto keys = extractKeys(array, keyFn, descending);
+    parallelSortKeys(keys);
+    permuteArray(array, keys);
+}
+
+// Первые k элементов упорядочены, остальные идут после них в исходном порядке.
+template<class T, class KeyFn>
+void partialSortByKey(Array<T>& array, size_t k, KeyFn keyFn, bool descending = false) {
+    auto keys = extractKeys(array, keyFn, descending);
+    auto head = selectSmallestKeys(keys, k);
+
+    std::vector<bool> taken(keys.size(), false);
+    for (const auto& entry : head) {
+        taken[entry.index] = true;
+    }
+    for (const auto& entry : keys) {
+        if (!taken[entry.index]) head.push_back(entry);
+    }
+    permuteArray(array, head);
+}
+
+template<class T, class KeyFn>
+Array<T> topKByKey(const Array<T>& array, size_t k, KeyFn keyFn, bool descending = true) {
+    auto keys = extractKeys(array, keyFn, descending);
+    auto head = selectSmallestKeys(keys, k);
+
+    Array<T> result;
+    result.reserve(head.size());
+    for (const auto& entry : head) {
+        result.push_back(array[entry.index]);
+    }
+    return result;
+}
+
+template<class T>
+double figureAreaKey(const std::shared_ptr<Figure<T>>& figure) {
+    return figure->area();
+}
+
+template<class T>
+double figureCenterXKey(const std::shared_ptr<Figure<T>>& figure) {
+    return static_cast<double>(figure->geometricCenter().getX());
+}
+
+template<class T>
+void sortByArea(Array<std::shared_ptr<Figure<T>>>& array, bool descending = false) {
+    sortByKey(array, figureAreaKey<T>, descending);
+}
+
+template<class T>
+void sortByCenterX(Array<std::shared_ptr<Figure<T>>>& array, bool descending = false) {
+    sortByKey(array, figureCenterXKey<T>, descending);
+}
+
+template<class T>
+void partialSortByArea(Array<std::shared_ptr<Figure<T>>>& array, size_t k, bool descending = false) {
+    partialSortByKey(array, k, figureAreaKey<T>, descending);
+}
+
+// k фигур с наибольшей площадью, по убыванию площади.
+template<class T>
+Array<std::shared_ptr<Figure<T>>> topKByArea(const Array<std::shared_ptr<Figure<T>>>& array, size_t k) {
+    return topKByKey(array, k, figureAreaKey<T>, true);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <limits>
+
+// Математика, вычислимая на этапе компиляции: std::sqrt/std::sin/std::cos
+// в C++17 не constexpr. Точность — в пределах нескольких ulp от <cmath>.
+
+constexpr double constexprPi = 3.14159265358979323846;
+
+constexpr double constexprSqrt(double value) {
+    if (value < 0 || value != value) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (value == 0 || value == std::numeric_limits<double>::infinity()) {
+        return value;
+    }
+
+    // Приводим аргумент к [0.25, 4) умножением на степени 4 (точно в двоичной арифметике)
+    double scale = 1;
+    while (value >= 4) {
+        value /= 4;
+        scale *= 2;
+    }
+    while (value < 0.25) {
+        value *= 4;
+        scale /= 2;
+    }
+
+    double guess = 1;
+    for (int i = 0; i < 8; ++i) {
+        guess = 0.5 * (guess + value / guess);
+    }
+    return guess * scale;
+}
+
+// Приведение угла к [-pi, pi]
+constexpr double constexprReduceAngle(double angle) {
+    double turns = angle / (2 * constexprPi);
+    long long whole = static_cast<long long>(turns < 0 ? turns - 0.5 : turns + 0.5);
+    return angle - 2 * constexprPi * static_cast<double>(whole);
+}
+
+constexpr double constexprSin(double angle) {
+    double x = constexprReduceAngle(angle);
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 14; ++n) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double angle) {
+    double x = constexprReduceAngle(angle);
+    double term = 1;
+    double sum = 1;
+    for (int n = 1; n < 14; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
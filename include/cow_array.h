@@ -0,0 +1,158 @@
+#pragma once
+#include "array.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Массив с разделяемым блочным хранилищем. Копия (снимок) стоит O(1):
+// копируется только указатель на таблицу блоков. Запись копирует таблицу
+// и лишь тот блок, который изменяется, если он разделён со снимком.
+// Снимок делает поток-писатель; готовые снимки можно читать из любых потоков.
+// Изменяемых ссылок на элементы нет: ссылка, взятая до снимка, писала бы
+// и в снимок. Элементы меняются только через set(), push_back и erase.
+template<typename T, size_t ChunkSize = 1024>
+class CowArray {
+    static_assert(ChunkSize > 0, "Chunk size must be positive");
+
+private:
+    using Chunk = std::vector<T>;
+    using ChunkTable = std::vector<std::shared_ptr<Chunk>>;
+
+    std::shared_ptr<ChunkTable> table;
+    size_t size_;
+
+    ChunkTable& mutableTable() {
+        if (!table) {
+            table = std::make_shared<ChunkTable>();
+        } else if (table.use_count() > 1) {
+            table = std::make_shared<ChunkTable>(*table);
+        }
+        return *table;
+    }
+
+    Chunk& mutableChunk(size_t chunkIndex) {
+        auto& chunk = mutableTable()[chunkIndex];
+        if (chunk.use_count() > 1) {
+            auto copy = std::make_shared<Chunk>();
+            copy->reserve(ChunkSize);
+            copy->assign(chunk->begin(), chunk->end());
+            chunk = std::move(copy);
+        }
+        return *chunk;
+    }
+
+public:
+    CowArray() : size_(0) {}
+
+    explicit CowArray(const Array<T>& array) : size_(0) {
+        for (const auto& value : array) {
+            push_back(value);
+        }
+    }
+
+    CowArray(const CowArray& other) = default;
+    CowArray& operator=(const CowArray& other) = default;
+
+    CowArray(CowArray&& other) noexcept : table(std::move(other.table)), size_(other.size_) {
+        other.size_ = 0;
+    }
+
+    CowArray& operator=(CowArray&& other) noexcept {
+        if (this != &other) {
+            table = std::move(other.table);
+            size_ = other.size_;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    CowArray snapshot() const {
+        return *this;
+    }
+
+    void push_back(T value) {
+        if (size_ % ChunkSize == 0) {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(ChunkSize);
+            mutableTable().push_back(std::move(chunk));
+        }
+        mutableChunk(size_ / ChunkSize).push_back(std::move(value));
+        ++size_;
+    }
+
+    void pop_back() {
+        if (size_ == 0) {
+            throw std::out_of_range("Index out of range");
+        }
+        --size_;
+        if (size_ % ChunkSize == 0) {
+            mutableTable().pop_back();
+        } else {
+            mutableChunk(size_ / ChunkSize).pop_back();
+        }
+    }
+
+    void erase(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        for (size_t i = index; i < size_ - 1; ++i) {
+            mutableChunk(i / ChunkSize)[i % ChunkSize] = (*this)[i + 1];
+        }
+        pop_back();
+    }
+
+    void set(size_t index, T value) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        mutableChunk(index / ChunkSize)[index % ChunkSize] = std::move(value);
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return (*(*table)[index / ChunkSize])[index % ChunkSize];
+    }
+
+    // Последовательный обход без проверок индекса, блок за блоком.
+    template<class F>
+    void forEach(F fn) const {
+        if (!table) return;
+        for (const auto& chunk : *table) {
+            for (const auto& value : *chunk) {
+                fn(value);
+            }
+        }
+    }
+
+    // Сколько блоков этот массив разделяет с другим (для диагностики).
+    size_t sharedChunks(const CowArray& other) const {
+        if (!table || !other.table) return 0;
+        size_t count = 0;
+        for (size_t c = 0; c < table->size() && c < other.table->size(); ++c) {
+            if ((*table)[c] == (*other.table)[c]) ++count;
+        }
+        return count;
+    }
+
+    Array<T> toArray() const {
+        Array<T> result;
+        result.reserve(size_);
+        forEach([&](const T& value) { result.push_back(value); });
+        return result;
+    }
+
+    size_t size() const { return size_; }
+    size_t chunkCount() const { return table ? table->size() : 0; }
+    static constexpr size_t chunk_size() { return ChunkSize; }
+
+    bool empty() const { return size_ == 0; }
+
+    void clear() {
+        table.reset();
+        size_ = 0;
+    }
+};
@@ -12,6 +12,11 @@ public:
     virtual Point<T> geometricCenter() const = 0;
     virtual double area() const = 0;
     virtual operator double() const { return area(); }
+
+    virtual size_t vertexCount() const = 0;
+    virtual const Point<T>& getVertex(size_t index) const = 0;
+    virtual void setVertex(size_t index, const Point<T>& point) = 0;
+    virtual size_t objectSize() const = 0;
     
     virtual bool operator==(const Figure<T>& other) const = 0;
     virtual bool operator!=(const Figure<T>& other) const {
@@ -0,0 +1,299 @@
+#pragma once
+#include "figure.h"
+#include "figure_buffer.h"
+#include "figure_bounds.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+// Сумма с компенсацией Ноймайера: накопленная ошибка не растёт с числом
+// добавлений и вычитаний.
+class CompensatedSum {
+private:
+    double sum = 0;
+    double compensation = 0;
+
+public:
+    void add(double value) {
+        double t = sum + value;
+        if (std::abs(sum) >= std::abs(value)) {
+            compensation += (sum - t) + value;
+        } else {
+            compensation += (value - t) + sum;
+        }
+        sum = t;
+    }
+
+    void subtract(double value) { add(-value); }
+    double value() const { return sum + compensation; }
+    void reset() { sum = 0; compensation = 0; }
+};
+
+// Характеристики фигуры, запоминаемые агрегатором вместо самой фигуры.
+struct FigureStats {
+    FigureKind kind;
+    double area;
+    Point<double> center;
+    BoundingBox<double> box;
+};
+
+template<class T>
+FigureStats figureStats(const Figure<T>& figure) {
+    size_t n = figure.vertexCount();
+    if (!isFigureKind(n)) {
+        throw std::invalid_argument("Unsupported figure");
+    }
+
+    FigureStats stats{static_cast<FigureKind>(n), figure.area(), Point<double>(), BoundingBox<double>()};
+    double x = 0, y = 0;
+    for (size_t v = 0; v < n; ++v) {
+        const Point<T>& p = figure.getVertex(v);
+        x += p.getX();
+        y += p.getY();
+        stats.box.extend(Point<double>(p.getX(), p.getY()));
+    }
+    stats.center = Point<double>(x / n, y / n);
+    return stats;
+}
+
+struct AggregateSnapshot {
+    size_t count = 0;
+    std::array<size_t, 3> perKind = {0, 0, 0};
+    double totalArea = 0;
+    Point<double> centroid;
+    BoundingBox<double> box;
+
+    size_t countOf(FigureKind kind) const { return perKind[vertexCountOf(kind) - 4]; }
+};
+
+struct ReconcileReport {
+    double areaDrift = 0;
+    double centroidDrift = 0;
+};
+
+// Инкрементальные агрегаты по набору фигур с идентификаторами.
+// Вставка, удаление и изменение стоят O(log n): суммы обновляются за O(1),
+// границы прямоугольника хранятся в упорядоченных мультимножествах.
+class FigureAggregator {
+private:
+    std::unordered_map<uint64_t, FigureStats> entries;
+    CompensatedSum areaSum, centerXSum, centerYSum;
+    std::array<size_t, 3> perKind = {0, 0, 0};
+    std::multiset<double> minXs, minYs, maxXs, maxYs;
+
+    void apply(const FigureStats& stats) {
+        areaSum.add(stats.area);
+        centerXSum.add(stats.center.getX());
+        centerYSum.add(stats.center.getY());
+        ++perKind[vertexCountOf(stats.kind) - 4];
+        minXs.insert(stats.box.minX);
+        minYs.insert(stats.box.minY);
+        maxXs.insert(stats.box.maxX);
+        maxYs.insert(stats.box.maxY);
+    }
+
+    void revert(const FigureStats& stats) {
+        areaSum.subtract(stats.area);
+        centerXSum.subtract(stats.center.getX());
+        centerYSum.subtract(stats.center.getY());
+        --perKind[vertexCountOf(stats.kind) - 4];
+        minXs.erase(minXs.find(stats.box.minX));
+        minYs.erase(minYs.find(stats.box.minY));
+        maxXs.erase(maxXs.find(stats.box.maxX));
+        maxYs.erase(maxYs.find(stats.box.maxY));
+    }
+
+public:
+    // NaN нарушил бы порядок мультимножеств, и revert() не нашёл бы свои границы
+    static void requireFinite(const FigureStats& stats) {
+        if (!std::isfinite(stats.area) || !std::isfinite(stats.box.minX) || !std::isfinite(stats.box.minY) ||
+            !std::isfinite(stats.box.maxX) || !std::isfinite(stats.box.maxY)) {
+            throw std::invalid_argument("Figure has non-finite coordinates");
+        }
+    }
+
+    template<class T>
+    void insert(uint64_t id, const Figure<T>& figure) {
+        insert(id, figureStats(figure));
+    }
+
+    void insert(uint64_t id, const FigureStats& stats) {
+        requireFinite(stats);
+        if (!entries.emplace(id, stats).second) {
+            throw std::invalid_argument("Figure id already present");
+        }
+        apply(stats);
+    }
+
+    void erase(uint64_t id) {
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            throw std::out_of_range("Unknown figure id");
+        }
+        revert(it->second);
+        entries.erase(it);
+    }
+
+    template<class T>
+    void update(uint64_t id, const Figure<T>& figure) {
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            throw std::out_of_range("Unknown figure id");
+        }
+        FigureStats stats = figureStats(figure);
+        requireFinite(stats);
+        revert(it->second);
+        it->second = stats;
+        apply(stats);
+    }
+
+    bool contains(uint64_t id) const { return entries.count(id) != 0; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    size_t count(FigureKind kind) const { return perKind[vertexCountOf(kind) - 4]; }
+    double totalArea() const { return areaSum.value(); }
+
+    Point<double> centroid() const {
+        if (entries.empty()) return Point<double>();
+        return Point<double>(centerXSum.value() / entries.size(), centerYSum.value() / entries.size());
+    }
+
+    BoundingBox<double> boundingBox() const {
+        BoundingBox<double> box;
+        if (!entries.empty()) {
+            box.minX = *minXs.begin();
+            box.minY = *minYs.begin();
+            box.maxX = *maxXs.rbegin();
+            box.maxY = *maxYs.rbegin();
+        }
+        return box;
+    }
+
+    AggregateSnapshot snapshot() const {
+        AggregateSnapshot s;
+        s.count = entries.size();
+        s.perKind = perKind;
+        s.totalArea = totalArea();
+        s.centroid = centroid();
+        s.box = boundingBox();
+        return s;
+    }
+
+    // Пересчёт сумм с нуля по сохранённым характеристикам; возвращает
+    // расхождение инкрементальных значений с пересчитанными и сбрасывает его.
+    ReconcileReport reconcile() {
+        Point<double> before = centroid();
+        double areaBefore = totalArea();
+
+        areaSum.reset();
+        centerXSum.reset();
+        centerYSum.reset();
+        for (const auto& entry : entries) {
+            areaSum.add(entry.second.area);
+            centerXSum.add(entry.second.center.getX());
+            centerYSum.add(entry.second.center.getY());
+        }
+
+        Point<double> after = centroid();
+        ReconcileReport report;
+        report.areaDrift = std::abs(areaBefore - totalArea());
+        report.centroidDrift = std::max(std::abs(before.getX() - after.getX()),
+                                        std::abs(before.getY() - after.getY()));
+        return report;
+    }
+
+    void clear() {
+        entries.clear();
+        areaSum.reset();
+        centerXSum.reset();
+        centerYSum.reset();
+        perKind = {0, 0, 0};
+        minXs.clear();
+        minYs.clear();
+        maxXs.clear();
+        maxYs.clear();
+    }
+};
+
+// Скользящее окно: учитываются фигуры, добавленные за последние window
+// единиц времени. Отметки времени должны не убывать.
+class SlidingWindowAggregator {
+private:
+    uint64_t window;
+    uint64_t nextId = 0;
+    std::deque<std::pair<uint64_t, uint64_t>> arrivals; // (время, id)
+    FigureAggregator aggregator;
+
+public:
+    explicit SlidingWindowAggregator(uint64_t window) : window(window) {
+        if (window == 0) {
+            throw std::invalid_argument("Window must be positive");
+        }
+    }
+
+    template<class T>
+    void add(uint64_t timestamp, const Figure<T>& figure) {
+        // Проверка до сдвига окна: отклонённая фигура не меняет состояние
+        FigureStats stats = figureStats(figure);
+        FigureAggregator::requireFinite(stats);
+        advance(timestamp);
+        aggregator.insert(nextId, stats);
+        arrivals.emplace_back(timestamp, nextId++);
+    }
+
+    void advance(uint64_t now) {
+        while (!arrivals.empty() && arrivals.front().first + window <= now) {
+            aggregator.erase(arrivals.front().second);
+            arrivals.pop_front();
+        }
+    }
+
+    const FigureAggregator& current() const { return aggregator; }
+    ReconcileReport reconcile() { return aggregator.reconcile(); }
+};
+
+// Неперекрывающиеся окна [k * window, (k + 1) * window). Когда событие
+// попадает в следующее окно, add() возвращает итог закрытого окна.
+class TumblingWindowAggregator {
+private:
+    uint64_t window;
+    uint64_t windowStart = 0;
+    bool started = false;
+    uint64_t nextId = 0;
+    FigureAggregator aggregator;
+
+public:
+    explicit TumblingWindowAggregator(uint64_t window) : window(window) {
+        if (window == 0) {
+            throw std::invalid_argument("Window must be positive");
+        }
+    }
+
+    template<class T>
+    std::optional<AggregateSnapshot> add(uint64_t timestamp, const Figure<T>& figure) {
+        // Проверка до закрытия окна: иначе при исключении итог закрытого окна терялся бы
+        FigureStats stats = figureStats(figure);
+        FigureAggregator::requireFinite(stats);
+
+        std::optional<AggregateSnapshot> closed;
+        uint64_t start = timestamp - timestamp % window;
+        if (!started) {
+            windowStart = start;
+            started = true;
+        } else if (start != windowStart) {
+            closed = aggregator.snapshot();
+            aggregator.clear();
+            windowStart = start;
+        }
+        aggregator.insert(nextId++, stats);
+        return closed;
+    }
+
+    uint64_t currentWindowStart() const { return windowStart; }
+    const FigureAggregator& current() const { return aggregator; }
+};
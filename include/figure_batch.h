@@ -0,0 +1,271 @@
+#pragma once
+#include "array.h"
+#include "figure_buffer.h"
+#include "parallel.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <vector>
+
+// Пакетное построение фигур из плоских буферов: виды фигур и подряд идущие
+// координаты x0 y0 x1 y1 ... Вместо исключения на каждую ошибку проверка
+// возвращает битовые маски: бит i установлен, если фигура i отклонена.
+
+enum class FigureError : uint8_t {
+    UnknownKind,  // байт вида не соответствует фигуре; дальше разбор невозможен
+    Truncated,    // координат не хватило (или фигура после неизвестного вида)
+    Degenerate,   // NaN/бесконечность, нулевая сторона, нулевая площадь, невыпуклый или самопересекающийся обход
+    UnequalSides, // у ромба стороны разной длины
+    Irregular     // пятиугольник или шестиугольник не правильный
+};
+
+constexpr size_t FigureErrorCount = 5;
+
+class FigureBatchErrors {
+private:
+    size_t count = 0;
+    std::vector<uint64_t> invalid;
+    std::array<std::vector<uint64_t>, FigureErrorCount> reasons;
+
+public:
+    FigureBatchErrors() = default;
+
+    explicit FigureBatchErrors(size_t count) : count(count), invalid((count + 63) / 64) {
+        for (auto& mask : reasons) {
+            mask.assign(invalid.size(), 0);
+        }
+    }
+
+    // Слово i / 64 пишет только один поток, поэтому пометки из разных блоков не гонятся
+    void mark(size_t index, FigureError error) {
+        uint64_t bit = uint64_t(1) << (index % 64);
+        invalid[index / 64] |= bit;
+        reasons[static_cast<size_t>(error)][index / 64] |= bit;
+    }
+
+    size_t size() const { return count; }
+    bool valid(size_t index) const { return !(invalid[index / 64] >> (index % 64) & 1); }
+
+    bool has(size_t index, FigureError error) const {
+        return reasons[static_cast<size_t>(error)][index / 64] >> (index % 64) & 1;
+    }
+
+    const std::vector<uint64_t>& bitmap() const { return invalid; }
+    const std::vector<uint64_t>& bitmap(FigureError error) const { return reasons[static_cast<size_t>(error)]; }
+
+    size_t invalidCount() const {
+        size_t total = 0;
+        for (uint64_t word : invalid) {
+            total += static_cast<size_t>(__builtin_popcountll(word));
+        }
+        return total;
+    }
+
+    bool allValid() const { return invalidCount() == 0; }
+};
+
+namespace batch_detail {
+
+// Проверка одной фигуры из N вершин. Циклы фиксированной длины без
+// ветвлений внутри, чтобы компилятор их развернул и векторизовал.
+template<size_t N, class T>
+void validatePolygon(const T* xy, double tolerance, bool regular, FigureBatchErrors& errors, size_t index) {
+    double x[N], y[N], side[N], radius[N], turn[N];
+    double cx = 0, cy = 0;
+    bool finite = true;
+    for (size_t v = 0; v < N; ++v) {
+        x[v] = static_cast<double>(xy[2 * v]);
+        y[v] = static_cast<double>(xy[2 * v + 1]);
+        finite &= std::isfinite(x[v]) & std::isfinite(y[v]);
+        cx += x[v];
+        cy += y[v];
+    }
+    if (!finite) {
+        errors.mark(index, FigureError::Degenerate);
+        return;
+    }
+    cx /= N;
+    cy /= N;
+
+    double area2 = 0;
+    for (size_t v = 0; v < N; ++v) {
+        size_t next = (v + 1) % N, after = (v + 2) % N;
+        double dx = x[next] - x[v], dy = y[next] - y[v];
+        side[v] = dx * dx + dy * dy;
+        radius[v] = (x[v] - cx) * (x[v] - cx) + (y[v] - cy) * (y[v] - cy);
+        turn[v] = dx * (y[after] - y[next]) - dy * (x[after] - x[next]);
+        area2 += (x[v] - cx) * (y[next] - cy) - (x[next] - cx) * (y[v] - cy);
+    }
+
+    // Одинаковые повороты бывают и у звезды (пентаграмма обходит центр дважды):
+    // у выпуклой фигуры все вершины лежат по одну сторону от каждой стороны
+    bool oneTurn = true;
+    for (size_t v = 0; v < N; ++v) {
+        size_t next = (v + 1) % N;
+        double dx = x[next] - x[v], dy = y[next] - y[v];
+        for (size_t k = 2; k < N; ++k) {
+            size_t w = (v + k) % N;
+            oneTurn &= (dx * (y[w] - y[v]) - dy * (x[w] - x[v])) * area2 > 0;
+        }
+    }
+
+    double minSide = side[0], maxSide = side[0], minRadius = radius[0], maxRadius = radius[0];
+    double minTurn = turn[0], maxTurn = turn[0];
+    for (size_t v = 1; v < N; ++v) {
+        minSide = std::min(minSide, side[v]);
+        maxSide = std::max(maxSide, side[v]);
+        minRadius = std::min(minRadius, radius[v]);
+        maxRadius = std::max(maxRadius, radius[v]);
+        minTurn = std::min(minTurn, turn[v]);
+        maxTurn = std::max(maxTurn, turn[v]);
+    }
+
+    // Нулевая сторона, площадь, исчезающе малая относительно сторон, смена направления обхода
+    // или самопересечение
+    if (minSide == 0 || std::abs(area2) <= tolerance * maxSide || (minTurn <= 0 && maxTurn >= 0) || !oneTurn) {
+        errors.mark(index, FigureError::Degenerate);
+        return;
+    }
+    if (maxSide - minSide > tolerance * maxSide) {
+        errors.mark(index, regular ? FigureError::Irregular : FigureError::UnequalSides);
+    } else if (regular && maxRadius - minRadius > tolerance * maxRadius) {
+        errors.mark(index, FigureError::Irregular);
+    }
+}
+
+} // namespace batch_detail
+
+// Проверяет count фигур; tolerance — допустимое относительное расхождение
+// квадратов длин сторон (и радиусов у правильных фигур).
+// offsets, если передан, получает смещение координат каждой фигуры.
+template<class T>
+FigureBatchErrors validateFigures(const FigureKind* kinds, size_t count, const T* coords, size_t coordCount,
+                                  double tolerance = 1e-6, std::vector<size_t>* offsets = nullptr) {
+    FigureBatchErrors errors(count);
+
+    // Смещения начала каждого блока из 64 фигур: блоки проверяются параллельно
+    std::vector<size_t> blockOffsets;
+    blockOffsets.reserve((count + 63) / 64);
+    size_t offset = 0, parsed = 0;
+    for (; parsed < count; ++parsed) {
+        if (parsed % 64 == 0) {
+            blockOffsets.push_back(offset);
+        }
+        size_t n = static_cast<size_t>(kinds[parsed]);
+        if (!isFigureKind(n)) {
+            errors.mark(parsed, FigureError::UnknownKind);
+            break;
+        }
+        if (offset + 2 * n > coordCount) {
+            errors.mark(parsed, FigureError::Truncated);
+            break;
+        }
+        offset += 2 * n;
+    }
+    for (size_t i = parsed + 1; i < count; ++i) {
+        errors.mark(i, FigureError::Truncated);
+    }
+
+    parallelFor(blockOffsets.size(), [&](size_t begin, size_t end, size_t) {
+        for (size_t block = begin; block < end; ++block) {
+            const T* xy = coords + blockOffsets[block];
+            size_t last = std::min(parsed, (block + 1) * 64);
+            for (size_t i = block * 64; i < last; ++i) {
+                switch (kinds[i]) {
+                case FigureKind::Rhombus:
+                    batch_detail::validatePolygon<4>(xy, tolerance, false, errors, i);
+                    break;
+                case FigureKind::Pentagon:
+                    batch_detail::validatePolygon<5>(xy, tolerance, true, errors, i);
+                    break;
+                case FigureKind::Hexagon:
+                    batch_detail::validatePolygon<6>(xy, tolerance, true, errors, i);
+                    break;
+                }
+                xy += 2 * vertexCountOf(kinds[i]);
+            }
+        }
+    }, 16);
+
+    if (offsets) {
+        offsets->resize(parsed);
+        size_t at = 0;
+        for (size_t i = 0; i < parsed; ++i) {
+            (*offsets)[i] = at;
+            at += 2 * vertexCountOf(kinds[i]);
+        }
+    }
+    return errors;
+}
+
+// Упакованный буфер из прошедших проверку фигур (в исходном порядке)
+template<class T>
+FigureBuffer<T> buildFigureBuffer(const FigureKind* kinds, size_t count, const T* coords, size_t coordCount,
+                                  FigureBatchErrors& errors, double tolerance = 1e-6) {
+    std::vector<size_t> offsets;
+    errors = validateFigures(kinds, count, coords, coordCount, tolerance, &offsets);
+
+    FigureBuffer<T> buffer;
+    buffer.reserve(count - errors.invalidCount(), coordCount);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        if (errors.valid(i)) {
+            buffer.push_back(kinds[i], coords + offsets[i]);
+        }
+    }
+    return buffer;
+}
+
+// Массив объектов-фигур из прошедших проверку фигур (в исходном порядке)
+template<class T>
+Array<std::shared_ptr<Figure<T>>> buildFigures(const FigureKind* kinds, size_t count, const T* coords,
+                                               size_t coordCount, FigureBatchErrors& errors,
+                                               double tolerance = 1e-6) {
+    std::vector<size_t> offsets;
+    errors = validateFigures(kinds, count, coords, coordCount, tolerance, &offsets);
+
+    std::vector<std::shared_ptr<Figure<T>>> built(offsets.size());
+    parallelFor(offsets.size(), [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            if (errors.valid(i)) {
+                built[i] = makeFigure(kinds[i], coords + offsets[i]);
+            }
+        }
+    });
+
+    Array<std::shared_ptr<Figure<T>>> figures;
+    figures.reserve(count - errors.invalidCount());
+    for (auto& figure : built) {
+        if (figure) {
+            figures.push_back(std::move(figure));
+        }
+    }
+    return figures;
+}
+
+template<class T>
+Array<std::shared_ptr<Figure<T>>> buildFigures(const std::vector<FigureKind>& kinds, const std::vector<T>& coords,
+                                               FigureBatchErrors& errors, double tolerance = 1e-6) {
+    return buildFigures(kinds.data(), kinds.size(), coords.data(), coords.size(), errors, tolerance);
+}
+
+// Чтение пакета из потока: на каждую фигуру число вершин и затем координаты.
+// Числа читаются подряд, без построения объектов по одной точке; неполная
+// или неизвестная фигура остаётся в kinds и будет отмечена при проверке.
+template<class T>
+size_t readFigureBatch(std::istream& is, std::vector<FigureKind>& kinds, std::vector<T>& coords) {
+    size_t before = kinds.size();
+    size_t n;
+    while (is >> n) {
+        kinds.push_back(static_cast<FigureKind>(isFigureKind(n) ? n : 0));
+        if (!isFigureKind(n)) {
+            break;
+        }
+        T value;
+        for (size_t c = 0; c < 2 * n && is >> value; ++c) {
+            coords.push_back(value);
+        }
+    }
+    return kinds.size() - before;
+}
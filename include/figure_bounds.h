@@ -0,0 +1,232 @@
+#pragma once
+#include "array.h"
+#include "figure.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+template<class T>
+struct BoundingBox {
+    T minX = std::numeric_limits<T>::max();
+    T minY = std::numeric_limits<T>::max();
+    T maxX = std::numeric_limits<T>::lowest();
+    T maxY = std::numeric_limits<T>::lowest();
+
+    bool empty() const { return minX > maxX; }
+    T width() const { return empty() ? 0 : maxX - minX; }
+    T height() const { return empty() ? 0 : maxY - minY; }
+
+    void extend(const Point<T>& p) {
+        minX = std::min(minX, p.getX());
+        minY = std::min(minY, p.getY());
+        maxX = std::max(maxX, p.getX());
+        maxY = std::max(maxY, p.getY());
+    }
+
+    void extend(const BoundingBox& other) {
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+};
+
+struct Circle {
+    Point<double> center;
+    double radius = -1;
+
+    bool empty() const { return radius < 0; }
+
+    bool contains(const Point<double>& p, double eps = 1e-9) const {
+        double dx = p.getX() - center.getX();
+        double dy = p.getY() - center.getY();
+        return !empty() && std::sqrt(dx * dx + dy * dy) <= radius * (1 + eps) + eps;
+    }
+};
+
+// Все вершины всех фигур подряд; позиции каждой фигуры находятся
+// префиксной суммой по vertexCount(), заполнение идёт параллельно.
+template<class T>
+std::vector<Point<T>> collectVertices(const Array<std::shared_ptr<Figure<T>>>& array) {
+    std::vector<size_t> offsets(array.size() + 1, 0);
+    for (size_t i = 0; i < array.size(); ++i) {
+        offsets[i + 1] = offsets[i] + array[i]->vertexCount();
+    }
+
+    std::vector<Point<T>> vertices(offsets.back());
+    const auto* figures = array.begin();
+    parallelFor(array.size(), [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            const Figure<T>& figure = *figures[i];
+            for (size_t v = 0; v < figure.vertexCount(); ++v) {
+                vertices[offsets[i] + v] = figure.getVertex(v);
+            }
+        }
+    });
+    return vertices;
+}
+
+template<class T>
+BoundingBox<T> boundingBox(const std::vector<Point<T>>& points) {
+    std::vector<BoundingBox<T>> partial(workerCount(points.size(), 1 << 16));
+    parallelFor(points.size(), [&](size_t begin, size_t end, size_t w) {
+        BoundingBox<T> box;
+        for (size_t i = begin; i < end; ++i) {
+            box.extend(points[i]);
+        }
+        partial[w] = box;
+    }, 1 << 16);
+
+    BoundingBox<T> result;
+    for (const auto& box : partial) {
+        result.extend(box);
+    }
+    return result;
+}
+
+template<class T>
+BoundingBox<T> boundingBox(const Array<std::shared_ptr<Figure<T>>>& array) {
+    std::vector<BoundingBox<T>> partial(workerCount(array.size()));
+    const auto* figures = array.begin();
+    parallelFor(array.size(), [&](size_t begin, size_t end, size_t w) {
+        BoundingBox<T> box;
+        for (size_t i = begin; i < end; ++i) {
+            const Figure<T>& figure = *figures[i];
+            for (size_t v = 0; v < figure.vertexCount(); ++v) {
+                box.extend(figure.getVertex(v));
+            }
+        }
+        partial[w] = box;
+    });
+
+    BoundingBox<T> result;
+    for (const auto& box : partial) {
+        result.extend(box);
+    }
+    return result;
+}
+
+template<class T>
+double cross(const Point<T>& o, const Point<T>& a, const Point<T>& b) {
+    return (static_cast<double>(a.getX()) - o.getX()) * (static_cast<double>(b.getY()) - o.getY()) -
+           (static_cast<double>(a.getY()) - o.getY()) * (static_cast<double>(b.getX()) - o.getX());
+}
+
+template<class T>
+bool lexicographicLess(const Point<T>& a, const Point<T>& b) {
+    return a.getX() < b.getX() || (a.getX() == b.getX() && a.getY() < b.getY());
+}
+
+// Монотонная цепочка Эндрю по отсортированным точкам; оболочка против часовой
+// стрелки без коллинеарных точек.
+template<class T>
+std::vector<Point<T>> monotoneChain(const std::vector<Point<T>>& sorted) {
+    size_t n = sorted.size();
+    if (n < 3) {
+        std::vector<Point<T>> hull(sorted);
+        if (n == 2 && sorted[0].getX() == sorted[1].getX() && sorted[0].getY() == sorted[1].getY()) {
+            hull.pop_back();
+        }
+        return hull;
+    }
+
+    std::vector<Point<T>> hull(2 * n);
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) --k;
+        hull[k++] = sorted[i];
+    }
+    for (size_t i = n - 1, lower = k + 1; i > 0; --i) {
+        while (k >= lower && cross(hull[k - 2], hull[k - 1], sorted[i - 1]) <= 0) --k;
+        hull[k++] = sorted[i - 1];
+    }
+    hull.resize(k - 1);
+    return hull;
+}
+
+// Каждый поток строит оболочку своего блока точек; итоговая оболочка
+// строится по объединению частичных, так как её вершины лежат среди них.
+template<class T>
+std::vector<Point<T>> convexHull(std::vector<Point<T>> points) {
+    const size_t minChunk = 1 << 16;
+    std::vector<std::vector<Point<T>>> partial(workerCount(points.size(), minChunk));
+    parallelFor(points.size(), [&](size_t begin, size_t end, size_t w) {
+        std::sort(points.begin() + begin, points.begin() + end, lexicographicLess<T>);
+        partial[w] = monotoneChain(std::vector<Point<T>>(points.begin() + begin, points.begin() + end));
+    }, minChunk);
+
+    if (partial.size() == 1) {
+        return partial[0];
+    }
+
+    std::vector<Point<T>> merged;
+    for (const auto& hull : partial) {
+        merged.insert(merged.end(), hull.begin(), hull.end());
+    }
+    std::sort(merged.begin(), merged.end(), lexicographicLess<T>);
+    return monotoneChain(merged);
+}
+
+template<class T>
+std::vector<Point<T>> convexHull(const Array<std::shared_ptr<Figure<T>>>& array) {
+    return convexHull(collectVertices(array));
+}
+
+inline Circle circleFrom(const Point<double>& a, const Point<double>& b) {
+    Point<double> center((a.getX() + b.getX()) / 2, (a.getY() + b.getY()) / 2);
+    double dx = a.getX() - center.getX();
+    double dy = a.getY() - center.getY();
+    return {center, std::sqrt(dx * dx + dy * dy)};
+}
+
+inline Circle circleFrom(const Point<double>& a, const Point<double>& b, const Point<double>& c) {
+    double bx = b.getX() - a.getX(), by = b.getY() - a.getY();
+    double cx = c.getX() - a.getX(), cy = c.getY() - a.getY();
+    double d = 2 * (bx * cy - by * cx);
+    if (d == 0) {
+        // Коллинеарные точки: окружность на самой дальней паре
+        Circle ab = circleFrom(a, b), ac = circleFrom(a, c), bc = circleFrom(b, c);
+        if (ab.radius >= ac.radius && ab.radius >= bc.radius) return ab;
+        return ac.radius >= bc.radius ? ac : bc;
+    }
+    double b2 = bx * bx + by * by;
+    double c2 = cx * cx + cy * cy;
+    double ux = (cy * b2 - by * c2) / d;
+    double uy = (bx * c2 - cx * b2) / d;
+    return {Point<double>(a.getX() + ux, a.getY() + uy), std::sqrt(ux * ux + uy * uy)};
+}
+
+// Алгоритм Велцля в итеративной форме (ожидаемое время O(n)) по вершинам оболочки.
+template<class T>
+Circle minimumEnclosingCircle(const std::vector<Point<T>>& points) {
+    std::vector<Point<double>> p;
+    p.reserve(points.size());
+    for (const auto& point : points) {
+        p.emplace_back(point.getX(), point.getY());
+    }
+    std::shuffle(p.begin(), p.end(), std::mt19937(12345));
+
+    Circle circle;
+    for (size_t i = 0; i < p.size(); ++i) {
+        if (circle.contains(p[i])) continue;
+        circle = {p[i], 0};
+        for (size_t j = 0; j < i; ++j) {
+            if (circle.contains(p[j])) continue;
+            circle = circleFrom(p[i], p[j]);
+            for (size_t k = 0; k < j; ++k) {
+                if (!circle.contains(p[k])) {
+                    circle = circleFrom(p[i], p[j], p[k]);
+                }
+            }
+        }
+    }
+    return circle;
+}
+
+template<class T>
+Circle minimumEnclosingCircle(const Array<std::shared_ptr<Figure<T>>>& array) {
+    return minimumEnclosingCircle(convexHull(array));
+}
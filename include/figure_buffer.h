@@ -0,0 +1,232 @@
+#pragma once
+#include "array.h"
+#include "figure.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include "hexagon.h"
+#include "parallel.h"
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Значение вида совпадает с числом вершин фигуры.
+enum class FigureKind : uint8_t {
+    Rhombus = 4,
+    Pentagon = 5,
+    Hexagon = 6
+};
+
+constexpr size_t vertexCountOf(FigureKind kind) {
+    return static_cast<size_t>(kind);
+}
+
+constexpr bool isFigureKind(size_t vertexCount) {
+    return vertexCount >= 4 && vertexCount <= 6;
+}
+
+// Площадь по упакованным координатам x0 y0 x1 y1 ...; формулы те же,
+// что в классах фигур, промежуточные значения в double.
+template<class T>
+double packedArea(FigureKind kind, const T* xy) {
+    auto distance = [xy](size_t a, size_t b) {
+        double dx = static_cast<double>(xy[2 * a]) - xy[2 * b];
+        double dy = static_cast<double>(xy[2 * a + 1]) - xy[2 * b + 1];
+        return std::sqrt(dx * dx + dy * dy);
+    };
+
+    switch (kind) {
+    case FigureKind::Rhombus: {
+        double d1 = distance(0, 2);
+        double d2 = distance(1, 3);
+        return (d1 * d2) / 2.0;
+    }
+    case FigureKind::Pentagon: {
+        double side = distance(0, 1);
+        return 0.25 * std::sqrt(5 * (5 + 2 * std::sqrt(5))) * side * side;
+    }
+    case FigureKind::Hexagon: {
+        double side = distance(0, 1);
+        return (3 * std::sqrt(3) / 2) * side * side;
+    }
+    }
+    throw std::invalid_argument("Unknown figure kind");
+}
+
+template<class T>
+Point<T> packedCenter(FigureKind kind, const T* xy) {
+    size_t n = vertexCountOf(kind);
+    T x = 0, y = 0;
+    for (size_t v = 0; v < n; ++v) {
+        x += xy[2 * v];
+        y += xy[2 * v + 1];
+    }
+    return Point<T>(x / static_cast<T>(n), y / static_cast<T>(n));
+}
+
+template<class T>
+std::shared_ptr<Figure<T>> makeFigure(FigureKind kind, const T* xy) {
+    auto p = [xy](size_t v) { return Point<T>(xy[2 * v], xy[2 * v + 1]); };
+    switch (kind) {
+    case FigureKind::Rhombus:
+        return std::make_shared<Rhombus<T>>(p(0), p(1), p(2), p(3));
+    case FigureKind::Pentagon:
+        return std::make_shared<Pentagon<T>>(p(0), p(1), p(2), p(3), p(4));
+    case FigureKind::Hexagon:
+        return std::make_shared<Hexagon<T>>(p(0), p(1), p(2), p(3), p(4), p(5));
+    }
+    throw std::invalid_argument("Unknown figure kind");
+}
+
+// Плотное хранение коллекции фигур: байт вида на фигуру и общий массив
+// координат. Смещение в массиве координат хранится только для каждой
+// OffsetStride-й фигуры, остальные получаются суммированием видов.
+template<class T>
+class FigureBuffer {
+public:
+    static constexpr size_t OffsetStride = 64;
+
+private:
+    std::vector<FigureKind> kinds;
+    std::vector<uint64_t> blockOffsets;
+    std::vector<T> coords;
+
+public:
+    FigureBuffer() = default;
+
+    explicit FigureBuffer(const Array<std::shared_ptr<Figure<T>>>& array) {
+        size_t coordinates = 0;
+        for (const auto& figure : array) {
+            coordinates += 2 * figure->vertexCount();
+        }
+        reserve(array.size(), coordinates);
+        for (const auto& figure : array) {
+            push_back(*figure);
+        }
+    }
+
+    void reserve(size_t figures, size_t coordinates) {
+        kinds.reserve(figures);
+        blockOffsets.reserve(figures / OffsetStride + 1);
+        coords.reserve(coordinates);
+    }
+
+    void push_back(FigureKind kind, const T* xy) {
+        if (kinds.size() % OffsetStride == 0) {
+            blockOffsets.push_back(coords.size());
+        }
+        kinds.push_back(kind);
+        coords.insert(coords.end(), xy, xy + 2 * vertexCountOf(kind));
+    }
+
+    void push_back(const Figure<T>& figure) {
+        size_t n = figure.vertexCount();
+        if (!isFigureKind(n)) {
+            throw std::invalid_argument("Unsupported figure");
+        }
+        T xy[12];
+        for (size_t v = 0; v < n; ++v) {
+            xy[2 * v] = figure.getVertex(v).getX();
+            xy[2 * v + 1] = figure.getVertex(v).getY();
+        }
+        push_back(static_cast<FigureKind>(n), xy);
+    }
+
+    size_t size() const { return kinds.size(); }
+    bool empty() const { return kinds.empty(); }
+
+    FigureKind kind(size_t index) const {
+        if (index >= kinds.size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return kinds[index];
+    }
+
+    size_t coordOffset(size_t index) const {
+        if (index > kinds.size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (index == kinds.size()) {
+            return coords.size();
+        }
+        size_t offset = blockOffsets[index / OffsetStride];
+        for (size_t i = index - index % OffsetStride; i < index; ++i) {
+            offset += 2 * vertexCountOf(kinds[i]);
+        }
+        return offset;
+    }
+
+    const T* vertices(size_t index) const {
+        return coords.data() + coordOffset(index);
+    }
+
+    double area(size_t index) const {
+        return packedArea(kind(index), vertices(index));
+    }
+
+    Point<T> geometricCenter(size_t index) const {
+        return packedCenter(kind(index), vertices(index));
+    }
+
+    std::shared_ptr<Figure<T>> figure(size_t index) const {
+        return makeFigure(kind(index), vertices(index));
+    }
+
+    // Обход фигур [begin, end) без повторного поиска смещения: fn(index, kind, xy).
+    template<class F>
+    void forEach(size_t begin, size_t end, F fn) const {
+        if (begin >= end) return;
+        size_t offset = coordOffset(begin);
+        for (size_t i = begin; i < end; ++i) {
+            fn(i, kinds[i], coords.data() + offset);
+            offset += 2 * vertexCountOf(kinds[i]);
+        }
+    }
+
+    double totalArea() const {
+        std::vector<double> partial(workerCount(size()));
+        parallelFor(size(), [&](size_t begin, size_t end, size_t w) {
+            double sum = 0;
+            forEach(begin, end, [&](size_t, FigureKind k, const T* xy) {
+                sum += packedArea(k, xy);
+            });
+            partial[w] = sum;
+        });
+
+        double total = 0;
+        for (double sum : partial) {
+            total += sum;
+        }
+        return total;
+    }
+
+    Array<std::shared_ptr<Figure<T>>> toArray() const {
+        Array<std::shared_ptr<Figure<T>>> result;
+        result.reserve(size());
+        forEach(0, size(), [&](size_t, FigureKind k, const T* xy) {
+            result.push_back(makeFigure(k, xy));
+        });
+        return result;
+    }
+
+    const FigureKind* kindData() const { return kinds.data(); }
+    const T* coordData() const { return coords.data(); }
+    size_t coordCount() const { return coords.size(); }
+
+    size_t memoryUsage() const {
+        return sizeof(*this) + kinds.capacity() * sizeof(FigureKind) +
+               blockOffsets.capacity() * sizeof(uint64_t) + coords.capacity() * sizeof(T);
+    }
+
+    void shrink_to_fit() {
+        kinds.shrink_to_fit();
+        blockOffsets.shrink_to_fit();
+        coords.shrink_to_fit();
+    }
+
+    void clear() {
+        kinds.clear();
+        blockOffsets.clear();
+        coords.clear();
+    }
+};
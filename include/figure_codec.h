@@ -0,0 +1,562 @@
+#pragma once
+#include "figure_buffer.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Сжатое колоночное представление FigureBuffer.
+//
+// Заголовок: "FGC1", размер T, число фигур, число правильных фигур, число
+// вершин, сохранённых явно. Далее секции с длиной в байтах впереди:
+//   виды фигур по 2 бита; битовая маска правильных фигур;
+//   колонки центр x, центр y, радиус, поворот для правильных фигур;
+//   колонки x и y вершин остальных фигур.
+// Вещественные колонки сжимаются XOR-кодированием соседних значений
+// (как в Gorilla), целочисленные — разностями с zigzag и varint.
+// Правильный многоугольник хранится параметрами, только если по ним вершины
+// восстанавливаются с ошибкой не больше tolerance (0 — без потерь, побитово).
+
+class BitWriter {
+private:
+    std::vector<uint8_t>& out;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void write(uint64_t value, unsigned count) {
+        if (count > 32) {
+            write(value >> 32, count - 32);
+            write(value, 32);
+            return;
+        }
+        if (count == 0) return;
+        acc = (acc << count) | (value & ((uint64_t(1) << count) - 1));
+        bits += count;
+        while (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>(acc >> bits));
+        }
+        acc &= (uint64_t(1) << bits) - 1;
+    }
+
+    void flush() {
+        if (bits > 0) {
+            out.push_back(static_cast<uint8_t>(acc << (8 - bits)));
+            acc = 0;
+            bits = 0;
+        }
+    }
+};
+
+class BitReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t bitPos = 0;
+
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint64_t read(unsigned count) {
+        if (count > 32) {
+            uint64_t high = read(count - 32);
+            return (high << 32) | read(32);
+        }
+        if (bitPos + count > size * 8) {
+            throw std::runtime_error("Corrupted figure stream");
+        }
+        uint64_t value = 0;
+        while (count > 0) {
+            unsigned available = 8 - (bitPos & 7);
+            unsigned take = available < count ? available : count;
+            unsigned byte = data[bitPos >> 3];
+            value = (value << take) | ((byte >> (available - take)) & ((1u << take) - 1));
+            bitPos += take;
+            count -= take;
+        }
+        return value;
+    }
+};
+
+namespace codec_detail {
+
+template<class T>
+using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+
+template<class T>
+Bits<T> toBits(T value) {
+    Bits<T> bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+template<class T>
+T fromBits(Bits<T> bits) {
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+inline unsigned leadingZeros(uint64_t x, unsigned width) {
+    return static_cast<unsigned>(__builtin_clzll(x)) - (64 - width);
+}
+
+inline unsigned trailingZeros(uint64_t x) {
+    return static_cast<unsigned>(__builtin_ctzll(x));
+}
+
+template<class T>
+void encodeXorColumn(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    constexpr unsigned width = sizeof(T) * 8;
+    BitWriter writer(out);
+    uint64_t prev = 0;
+    unsigned prevLead = width + 1, prevTrail = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        uint64_t current = toBits(values[i]);
+        if (i == 0) {
+            writer.write(current, width);
+            prev = current;
+            continue;
+        }
+        uint64_t x = current ^ prev;
+        prev = current;
+        if (x == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+        writer.write(1, 1);
+        unsigned lead = leadingZeros(x, width);
+        unsigned trail = trailingZeros(x);
+        if (prevLead <= width && lead >= prevLead && trail >= prevTrail) {
+            writer.write(0, 1);
+            writer.write(x >> prevTrail, width - prevLead - prevTrail);
+        } else {
+            unsigned length = width - lead - trail;
+            writer.write(1, 1);
+            writer.write(lead, 6);
+            writer.write(length - 1, 6);
+            writer.write(x >> trail, length);
+            prevLead = lead;
+            prevTrail = trail;
+        }
+    }
+    writer.flush();
+}
+
+template<class T>
+std::vector<T> decodeXorColumn(const uint8_t* data, size_t size, size_t count) {
+    constexpr unsigned width = sizeof(T) * 8;
+    if (count > size * 8) {
+        throw std::runtime_error("Corrupted figure stream");
+    }
+    std::vector<T> values(count);
+    BitReader reader(data, size);
+    uint64_t prev = 0;
+    unsigned prevLead = width + 1, prevTrail = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 0) {
+            prev = reader.read(width);
+        } else if (reader.read(1) != 0) {
+            if (reader.read(1) == 0) {
+                if (prevLead > width) {
+                    throw std::runtime_error("Corrupted figure stream");
+                }
+                prev ^= reader.read(width - prevLead - prevTrail) << prevTrail;
+            } else {
+                unsigned lead = static_cast<unsigned>(reader.read(6));
+                unsigned length = static_cast<unsigned>(reader.read(6)) + 1;
+                if (lead + length > width) {
+                    throw std::runtime_error("Corrupted figure stream");
+                }
+                unsigned trail = width - lead - length;
+                prev ^= reader.read(length) << trail;
+                prevLead = lead;
+                prevTrail = trail;
+            }
+        }
+        values[i] = fromBits<T>(static_cast<Bits<T>>(prev));
+    }
+    return values;
+}
+
+template<class T>
+void encodeDeltaColumn(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    uint64_t prev = 0;
+    for (T value : values) {
+        uint64_t current = static_cast<uint64_t>(static_cast<int64_t>(value));
+        int64_t delta = static_cast<int64_t>(current - prev);
+        prev = current;
+        uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        while (zigzag >= 0x80) {
+            out.push_back(static_cast<uint8_t>(zigzag | 0x80));
+            zigzag >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(zigzag));
+    }
+}
+
+template<class T>
+std::vector<T> decodeDeltaColumn(const uint8_t* data, size_t size, size_t count) {
+    if (count > size) {
+        throw std::runtime_error("Corrupted figure stream");
+    }
+    std::vector<T> values(count);
+    size_t pos = 0;
+    uint64_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t zigzag = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (pos >= size || shift > 63) {
+                throw std::runtime_error("Corrupted figure stream");
+            }
+            uint8_t byte = data[pos++];
+            zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) break;
+        }
+        int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        prev += static_cast<uint64_t>(delta);
+        values[i] = static_cast<T>(static_cast<int64_t>(prev));
+    }
+    return values;
+}
+
+template<class T>
+void encodeColumn(const std::vector<T>& values, std::vector<uint8_t>& out) {
+    if constexpr (std::is_floating_point<T>::value) {
+        encodeXorColumn(values, out);
+    } else {
+        encodeDeltaColumn(values, out);
+    }
+}
+
+template<class T>
+std::vector<T> decodeColumn(const uint8_t* data, size_t size, size_t count) {
+    if constexpr (std::is_floating_point<T>::value) {
+        return decodeXorColumn<T>(data, size, count);
+    } else {
+        return decodeDeltaColumn<T>(data, size, count);
+    }
+}
+
+// cos/sin углов 2*pi*i/n, вычисленные так же, как в конструкторах
+// Pentagon/Hexagon по центру и радиусу.
+struct UnitAngles {
+    std::array<std::array<double, 6>, 7> cosines;
+    std::array<std::array<double, 6>, 7> sines;
+
+    UnitAngles() : cosines(), sines() {
+        for (int n = 4; n <= 6; ++n) {
+            for (int i = 0; i < n; ++i) {
+                double angle = 2 * M_PI * i / n;
+                cosines[n][i] = std::cos(angle);
+                sines[n][i] = std::sin(angle);
+            }
+        }
+    }
+};
+
+inline const UnitAngles& unitAngles() {
+    static const UnitAngles angles;
+    return angles;
+}
+
+struct RegularParams {
+    double centerX, centerY, radius, rotation;
+};
+
+template<class T>
+void reconstructRegular(size_t n, const RegularParams& p, T* xy) {
+    const UnitAngles& angles = unitAngles();
+    if (p.rotation == 0) {
+        const double* c = angles.cosines[n].data();
+        const double* s = angles.sines[n].data();
+        for (size_t i = 0; i < n; ++i) {
+            xy[2 * i] = p.centerX + p.radius * c[i];
+            xy[2 * i + 1] = p.centerY + p.radius * s[i];
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            double angle = p.rotation + 2 * M_PI * i / n;
+            xy[2 * i] = p.centerX + p.radius * std::cos(angle);
+            xy[2 * i + 1] = p.centerY + p.radius * std::sin(angle);
+        }
+    }
+}
+
+template<class T>
+bool reconstructsWithin(size_t n, const RegularParams& p, const T* xy, double tolerance) {
+    T restored[12];
+    reconstructRegular(n, p, restored);
+    for (size_t i = 0; i < 2 * n; ++i) {
+        if (tolerance == 0 ? toBits(restored[i]) != toBits(xy[i])
+                           : !(std::abs(restored[i] - xy[i]) <= tolerance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Подбор параметров: центр как среднее вершин, радиус и поворот по первой
+// вершине. Для точного режима без поворота координаты x и y проверяются
+// раздельно: y первой вершины равен y центра точно, радиус ищется среди
+// соседних представимых значений по y, затем центр x — по x.
+template<class T>
+bool detectRegular(FigureKind kind, const T* xy, double tolerance, RegularParams& params) {
+    size_t n = vertexCountOf(kind);
+    double cx = 0, cy = 0;
+    for (size_t i = 0; i < n; ++i) {
+        cx += xy[2 * i];
+        cy += xy[2 * i + 1];
+    }
+    cx /= n;
+    cy /= n;
+    double radius = std::hypot(xy[0] - cx, xy[1] - cy);
+    if (!(radius > 0) || !std::isfinite(radius)) return false;
+
+    double rotation = std::atan2(xy[1] - cy, xy[0] - cx);
+    if (std::abs(rotation) < 1e-12) rotation = 0;
+
+    params = {cx, cy, radius, rotation};
+    if (reconstructsWithin(n, params, xy, tolerance)) return true;
+    if (tolerance != 0 || rotation != 0 || !std::is_floating_point<T>::value) return false;
+
+    const UnitAngles& angles = unitAngles();
+    const double* cosines = angles.cosines[n].data();
+    const double* sines = angles.sines[n].data();
+    auto axisMatches = [&](double center, double r, const double* unit, size_t axis) {
+        for (size_t i = 0; i < n; ++i) {
+            T value = center + r * unit[i];
+            if (toBits(value) != toBits(xy[2 * i + axis])) return false;
+        }
+        return true;
+    };
+    auto nearby = [](double base, int steps) {
+        double value = base;
+        for (int k = 0; k < (steps < 0 ? -steps : steps); ++k) {
+            value = std::nextafter(value, steps < 0 ? -INFINITY : INFINITY);
+        }
+        return value;
+    };
+
+    // Оценки радиуса точны лишь до ulp координат, поэтому радиус перебирается
+    // с шагом в долю ulp наибольшей координаты, а центр x — по соседним значениям.
+    double scale = 0;
+    for (size_t i = 0; i < 2 * n; ++i) {
+        scale = std::max(scale, std::abs(static_cast<double>(xy[i])));
+    }
+    double step = (std::nextafter(scale, INFINITY) - scale) / 8;
+    size_t far = n / 2;
+    double centerY = xy[1];
+    double fromX = (xy[0] - xy[2 * far]) / (cosines[0] - cosines[far]);
+    double fromY = (xy[3] - centerY) / sines[1];
+    auto tryRadius = [&](double r) {
+        if (!(r > 0) || !axisMatches(centerY, r, sines, 1)) return false;
+        for (int dc = -2; dc <= 2; ++dc) {
+            double centerX = nearby(xy[0] - r, dc);
+            if (axisMatches(centerX, r, cosines, 0)) {
+                params = {centerX, centerY, r, 0};
+                return true;
+            }
+        }
+        return false;
+    };
+    for (double radiusBase : {fromX, fromY, radius}) {
+        for (int k = -16; k <= 16; ++k) {
+            if (tryRadius(radiusBase + k * step)) return true;
+        }
+        double r = nearby(radiusBase, -48);
+        for (int k = -48; k <= 48; ++k, r = std::nextafter(r, INFINITY)) {
+            if (tryRadius(r)) return true;
+        }
+    }
+    return false;
+}
+
+inline void writeU64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+class ByteReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+public:
+    ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    const uint8_t* take(size_t count) {
+        if (count > size - pos) {
+            throw std::runtime_error("Corrupted figure stream");
+        }
+        const uint8_t* p = data + pos;
+        pos += count;
+        return p;
+    }
+
+    uint64_t readU64() {
+        const uint8_t* p = take(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    // Секция: длина в байтах и содержимое
+    std::pair<const uint8_t*, size_t> section() {
+        uint64_t length = readU64();
+        if (length > size - pos) {
+            throw std::runtime_error("Corrupted figure stream");
+        }
+        return {take(static_cast<size_t>(length)), static_cast<size_t>(length)};
+    }
+
+    bool atEnd() const { return pos == size; }
+};
+
+inline void writeSection(std::vector<uint8_t>& out, const std::vector<uint8_t>& section) {
+    writeU64(out, section.size());
+    out.insert(out.end(), section.begin(), section.end());
+}
+
+} // namespace codec_detail
+
+template<class T>
+std::vector<uint8_t> encodeFigures(const FigureBuffer<T>& buffer, double tolerance = 0) {
+    using namespace codec_detail;
+    size_t count = buffer.size();
+
+    std::vector<uint8_t> kinds((count + 3) / 4, 0);
+    std::vector<uint8_t> regularFlags((count + 7) / 8, 0);
+    std::vector<double> centerX, centerY, radius, rotation;
+    std::vector<T> xs, ys;
+
+    buffer.forEach(0, count, [&](size_t i, FigureKind kind, const T* xy) {
+        kinds[i / 4] |= static_cast<uint8_t>((vertexCountOf(kind) - 4) << (2 * (i % 4)));
+
+        RegularParams params;
+        if (std::is_floating_point<T>::value && kind != FigureKind::Rhombus &&
+            detectRegular(kind, xy, tolerance, params)) {
+            regularFlags[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            centerX.push_back(params.centerX);
+            centerY.push_back(params.centerY);
+            radius.push_back(params.radius);
+            rotation.push_back(params.rotation);
+            return;
+        }
+        for (size_t v = 0; v < vertexCountOf(kind); ++v) {
+            xs.push_back(xy[2 * v]);
+            ys.push_back(xy[2 * v + 1]);
+        }
+    });
+
+    std::vector<uint8_t> out = {'F', 'G', 'C', '1', static_cast<uint8_t>(sizeof(T))};
+    writeU64(out, count);
+    writeU64(out, centerX.size());
+    writeU64(out, xs.size());
+    writeSection(out, kinds);
+    writeSection(out, regularFlags);
+
+    std::vector<uint8_t> column;
+    for (const auto* values : {&centerX, &centerY, &radius, &rotation}) {
+        column.clear();
+        encodeXorColumn(*values, column);
+        writeSection(out, column);
+    }
+    for (const auto* values : {&xs, &ys}) {
+        column.clear();
+        encodeColumn(*values, column);
+        writeSection(out, column);
+    }
+    return out;
+}
+
+template<class T>
+FigureBuffer<T> decodeFigures(const uint8_t* data, size_t size) {
+    using namespace codec_detail;
+    ByteReader reader(data, size);
+
+    const uint8_t* magic = reader.take(5);
+    if (std::memcmp(magic, "FGC1", 4) != 0 || magic[4] != sizeof(T)) {
+        throw std::runtime_error("Not a figure stream");
+    }
+    uint64_t count = reader.readU64();
+    uint64_t regularCount = reader.readU64();
+    uint64_t rawVertexCount = reader.readU64();
+
+    auto kinds = reader.section();
+    auto flags = reader.section();
+    if (count > kinds.second * 4 || kinds.second != (count + 3) / 4 || flags.second != (count + 7) / 8) {
+        throw std::runtime_error("Corrupted figure stream");
+    }
+
+    // Сверка счётчиков заголовка с видами и маской до выделения памяти под колонки
+    uint64_t regularSeen = 0, rawSeen = 0;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned code = (kinds.first[i / 4] >> (2 * (i % 4))) & 3;
+        if (code > 2) {
+            throw std::runtime_error("Corrupted figure stream");
+        }
+        if (flags.first[i / 8] & (1u << (i % 8))) {
+            ++regularSeen;
+        } else {
+            rawSeen += code + 4;
+        }
+    }
+    if (regularSeen != regularCount || rawSeen != rawVertexCount ||
+        (!std::is_floating_point<T>::value && regularCount != 0)) {
+        throw std::runtime_error("Corrupted figure stream");
+    }
+
+    std::vector<double> params[4];
+    for (auto& column : params) {
+        auto section = reader.section();
+        column = decodeXorColumn<double>(section.first, section.second, regularCount);
+    }
+    std::vector<T> coords[2];
+    for (auto& column : coords) {
+        auto section = reader.section();
+        column = decodeColumn<T>(section.first, section.second, rawVertexCount);
+    }
+    if (!reader.atEnd()) {
+        throw std::runtime_error("Corrupted figure stream");
+    }
+
+    FigureBuffer<T> buffer;
+    buffer.reserve(count, 2 * (rawVertexCount + 6 * regularCount));
+    size_t regular = 0, raw = 0;
+    T xy[12];
+    for (size_t i = 0; i < count; ++i) {
+        FigureKind kind = static_cast<FigureKind>(((kinds.first[i / 4] >> (2 * (i % 4))) & 3) + 4);
+        size_t n = vertexCountOf(kind);
+        if (flags.first[i / 8] & (1u << (i % 8))) {
+            RegularParams p = {params[0][regular], params[1][regular], params[2][regular], params[3][regular]};
+            reconstructRegular(n, p, xy);
+            ++regular;
+        } else {
+            const T* x = coords[0].data() + raw;
+            const T* y = coords[1].data() + raw;
+            for (size_t v = 0; v < n; ++v) {
+                xy[2 * v] = x[v];
+                xy[2 * v + 1] = y[v];
+            }
+            raw += n;
+        }
+        buffer.push_back(kind, xy);
+    }
+    return buffer;
+}
+
+template<class T>
+FigureBuffer<T> decodeFigures(const std::vector<uint8_t>& data) {
+    return decodeFigures<T>(data.data(), data.size());
+}
@@ -0,0 +1,368 @@
+#pragma once
+#include "array.h"
+#include "figure.h"
+#include "figure_buffer.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Соединение двух наборов фигур по центрам: k ближайших соседей и все пары
+// в пределах радиуса. Центры считаются один раз (без виртуальных вызовов в
+// цикле сравнения), правый набор индексируется k-d деревом, а запросы идут в
+// пространственном порядке, чтобы соседние запросы обходили одни и те же листья.
+
+// Пара индексов: left — фигура левого набора, right — правого
+struct IndexPair {
+    uint32_t left;
+    uint32_t right;
+
+    bool operator==(const IndexPair& other) const { return left == other.left && right == other.right; }
+};
+
+// Центры фигур отдельными массивами x и y
+struct CentroidSet {
+    std::vector<double> x, y;
+
+    size_t size() const { return x.size(); }
+
+    void push_back(double px, double py) {
+        x.push_back(px);
+        y.push_back(py);
+    }
+};
+
+template<class T>
+CentroidSet centroids(const Array<std::shared_ptr<Figure<T>>>& array) {
+    CentroidSet set;
+    set.x.resize(array.size());
+    set.y.resize(array.size());
+    const auto* figures = array.begin();
+    parallelFor(array.size(), [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            Point<T> c = figures[i]->geometricCenter();
+            set.x[i] = static_cast<double>(c.getX());
+            set.y[i] = static_cast<double>(c.getY());
+        }
+    });
+    return set;
+}
+
+template<class T>
+CentroidSet centroids(const FigureBuffer<T>& buffer) {
+    CentroidSet set;
+    set.x.resize(buffer.size());
+    set.y.resize(buffer.size());
+    parallelFor(buffer.size(), [&](size_t begin, size_t end, size_t) {
+        buffer.forEach(begin, end, [&](size_t i, FigureKind kind, const T* xy) {
+            Point<T> c = packedCenter(kind, xy);
+            set.x[i] = static_cast<double>(c.getX());
+            set.y[i] = static_cast<double>(c.getY());
+        });
+    });
+    return set;
+}
+
+// Сбалансированное k-d дерево в неявной раскладке: у узла i дети 2i+1 и 2i+2,
+// все листья на глубине depth, лист хранит не больше LeafSize точек. Точки
+// переупорядочены так, что каждый узел — непрерывный отрезок массивов x, y, id.
+class CentroidTree {
+public:
+    static constexpr size_t LeafSize = 32;
+
+    struct Box {
+        double minX, minY, maxX, maxY;
+
+        // Квадрат расстояния от точки до прямоугольника (0 внутри)
+        double distance2(double px, double py) const {
+            double dx = std::max(std::max(minX - px, px - maxX), 0.0);
+            double dy = std::max(std::max(minY - py, py - maxY), 0.0);
+            return dx * dx + dy * dy;
+        }
+    };
+
+private:
+    struct Entry {
+        double x, y;
+        uint32_t id;
+    };
+
+    size_t count = 0;
+    size_t depth = 0;
+    std::vector<double> xs, ys;
+    std::vector<uint32_t> ids;
+    std::vector<Box> boxes;
+
+    size_t rangeBegin(size_t node, size_t level) const {
+        size_t position = node + 1 - (size_t(1) << level);
+        return position * count >> level;
+    }
+
+    size_t rangeEnd(size_t node, size_t level) const {
+        size_t position = node + 2 - (size_t(1) << level);
+        return position * count >> level;
+    }
+
+    // Рамка отрезка и разбиение по медиане вдоль более длинной стороны
+    void split(std::vector<Entry>& entries, size_t node, size_t level) {
+        size_t begin = rangeBegin(node, level), end = rangeEnd(node, level);
+        Box box{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+        for (size_t i = begin; i < end; ++i) {
+            box.minX = std::min(box.minX, entries[i].x);
+            box.minY = std::min(box.minY, entries[i].y);
+            box.maxX = std::max(box.maxX, entries[i].x);
+            box.maxY = std::max(box.maxY, entries[i].y);
+        }
+        boxes[node] = box;
+        if (level == depth) return;
+
+        size_t mid = rangeEnd(2 * node + 1, level + 1);
+        auto first = entries.begin() + begin, middle = entries.begin() + mid, last = entries.begin() + end;
+        if (box.maxX - box.minX >= box.maxY - box.minY) {
+            std::nth_element(first, middle, last, [](const Entry& a, const Entry& b) { return a.x < b.x; });
+        } else {
+            std::nth_element(first, middle, last, [](const Entry& a, const Entry& b) { return a.y < b.y; });
+        }
+    }
+
+    void build(std::vector<Entry>& entries, size_t node, size_t level) {
+        split(entries, node, level);
+        if (level < depth) {
+            build(entries, 2 * node + 1, level + 1);
+            build(entries, 2 * node + 2, level + 1);
+        }
+    }
+
+    static size_t levelOf(size_t node) {
+        size_t level = 0;
+        while ((size_t(2) << level) <= node + 1) ++level;
+        return level;
+    }
+
+public:
+    CentroidTree() = default;
+
+    explicit CentroidTree(const CentroidSet& points) : count(points.size()) {
+        if (count > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Too many figures for IndexPair");
+        }
+        while ((count + (size_t(1) << depth) - 1) >> depth > LeafSize) ++depth;
+
+        std::vector<Entry> entries(count);
+        parallelFor(count, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                entries[i] = {points.x[i], points.y[i], static_cast<uint32_t>(i)};
+            }
+        });
+        boxes.resize((size_t(2) << depth) - 1);
+
+        // Верхние уровни по очереди, затем поддеревья параллельно
+        size_t top = 0;
+        while (top < depth && (size_t(1) << top) < workerCount(count, 1 << 16)) ++top;
+        for (size_t level = 0; level < top; ++level) {
+            for (size_t node = (size_t(1) << level) - 1; node < (size_t(2) << level) - 1; ++node) {
+                split(entries, node, level);
+            }
+        }
+        size_t first = (size_t(1) << top) - 1;
+        parallelFor(size_t(1) << top, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                build(entries, first + i, top);
+            }
+        }, 1);
+
+        xs.resize(count);
+        ys.resize(count);
+        ids.resize(count);
+        parallelFor(count, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                xs[i] = entries[i].x;
+                ys[i] = entries[i].y;
+                ids[i] = entries[i].id;
+            }
+        });
+    }
+
+    size_t size() const { return count; }
+    size_t leafCount() const { return count == 0 ? 0 : size_t(1) << depth; }
+
+    // Точки в порядке дерева: соседние позиции близки в пространстве
+    const double* xData() const { return xs.data(); }
+    const double* yData() const { return ys.data(); }
+    const uint32_t* idData() const { return ids.data(); }
+
+    // k ближайших к (qx, qy) в порядке возрастания расстояния, при равенстве —
+    // по возрастанию индекса. dist и id вмещают k значений; возвращает число найденных.
+    size_t nearest(double qx, double qy, size_t k, double* dist, uint32_t* id) const {
+        if (count == 0 || k == 0) return 0;
+        size_t found = 0;
+        double worst = std::numeric_limits<double>::infinity();
+        double d2[LeafSize];
+
+        struct Pending {
+            size_t node, level;
+            double distance2;
+        } stack[64];
+        size_t top = 0;
+        stack[top++] = {0, 0, 0.0};
+
+        while (top > 0) {
+            Pending item = stack[--top];
+            if (item.distance2 > worst) continue;
+            if (item.level == depth) {
+                size_t begin = rangeBegin(item.node, item.level), n = rangeEnd(item.node, item.level) - begin;
+                const double* lx = xs.data() + begin;
+                const double* ly = ys.data() + begin;
+                // Расстояния до всего листа одним циклом без ветвлений
+                for (size_t j = 0; j < n; ++j) {
+                    double dx = lx[j] - qx, dy = ly[j] - qy;
+                    d2[j] = dx * dx + dy * dy;
+                }
+                for (size_t j = 0; j < n; ++j) {
+                    uint32_t candidate = ids[begin + j];
+                    if (d2[j] > worst || (found == k && d2[j] == worst && candidate > id[k - 1])) continue;
+                    size_t at = found < k ? found++ : k - 1;
+                    while (at > 0 && (dist[at - 1] > d2[j] || (dist[at - 1] == d2[j] && id[at - 1] > candidate))) {
+                        dist[at] = dist[at - 1];
+                        id[at] = id[at - 1];
+                        --at;
+                    }
+                    dist[at] = d2[j];
+                    id[at] = candidate;
+                    if (found == k) worst = dist[k - 1];
+                }
+                continue;
+            }
+            size_t left = 2 * item.node + 1, right = left + 1;
+            double leftDistance = boxes[left].distance2(qx, qy);
+            double rightDistance = boxes[right].distance2(qx, qy);
+            // Ближний ребёнок снимается со стека первым
+            if (leftDistance <= rightDistance) {
+                stack[top++] = {right, item.level + 1, rightDistance};
+                stack[top++] = {left, item.level + 1, leftDistance};
+            } else {
+                stack[top++] = {left, item.level + 1, leftDistance};
+                stack[top++] = {right, item.level + 1, rightDistance};
+            }
+        }
+        return found;
+    }
+
+    // Вызывает fn(id) для каждой точки на расстоянии не больше radius от (qx, qy)
+    template<class F>
+    void within(double qx, double qy, double radius, F fn) const {
+        if (count == 0 || !(radius >= 0)) return;
+        double r2 = radius * radius;
+        double d2[LeafSize];
+        size_t stack[64];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            size_t node = stack[--top];
+            if (boxes[node].distance2(qx, qy) > r2) continue;
+            size_t level = levelOf(node);
+            if (level < depth) {
+                stack[top++] = 2 * node + 2;
+                stack[top++] = 2 * node + 1;
+                continue;
+            }
+            size_t begin = rangeBegin(node, level), n = rangeEnd(node, level) - begin;
+            const double* lx = xs.data() + begin;
+            const double* ly = ys.data() + begin;
+            for (size_t j = 0; j < n; ++j) {
+                double dx = lx[j] - qx, dy = ly[j] - qy;
+                d2[j] = dx * dx + dy * dy;
+            }
+            for (size_t j = 0; j < n; ++j) {
+                if (d2[j] <= r2) fn(ids[begin + j]);
+            }
+        }
+    }
+};
+
+// Для каждой фигуры левого набора min(k, right.size()) ближайших правых:
+// пары фигуры i лежат подряд с позиции i * min(k, right.size()), ближние первыми.
+inline std::vector<IndexPair> knnJoin(const CentroidSet& left, const CentroidTree& right, size_t k) {
+    size_t per = std::min(k, right.size());
+    std::vector<IndexPair> pairs(left.size() * per);
+    if (per == 0) return pairs;
+
+    CentroidTree order(left);
+    const double* qx = order.xData();
+    const double* qy = order.yData();
+    const uint32_t* qid = order.idData();
+    parallelFor(left.size(), [&](size_t begin, size_t end, size_t) {
+        std::vector<double> dist(per);
+        std::vector<uint32_t> id(per);
+        for (size_t q = begin; q < end; ++q) {
+            right.nearest(qx[q], qy[q], per, dist.data(), id.data());
+            IndexPair* out = pairs.data() + static_cast<size_t>(qid[q]) * per;
+            for (size_t j = 0; j < per; ++j) {
+                out[j] = {qid[q], id[j]};
+            }
+        }
+    }, 1024);
+    return pairs;
+}
+
+// Все пары на расстоянии не больше radius, по возрастанию left, затем right
+inline std::vector<IndexPair> radiusJoin(const CentroidSet& left, const CentroidTree& right, double radius) {
+    CentroidTree order(left);
+    const double* qx = order.xData();
+    const double* qy = order.yData();
+    const uint32_t* qid = order.idData();
+
+    std::vector<std::vector<IndexPair>> partial(workerCount(left.size(), 1024));
+    parallelFor(left.size(), [&](size_t begin, size_t end, size_t w) {
+        std::vector<IndexPair>& out = partial[w];
+        for (size_t q = begin; q < end; ++q) {
+            size_t first = out.size();
+            right.within(qx[q], qy[q], radius, [&](uint32_t id) { out.push_back({qid[q], id}); });
+            std::sort(out.begin() + first, out.end(),
+                      [](const IndexPair& a, const IndexPair& b) { return a.right < b.right; });
+        }
+    }, 1024);
+
+    // Устойчивая сортировка подсчётом по left: порядок right внутри сохраняется
+    std::vector<size_t> start(left.size() + 1, 0);
+    for (const auto& part : partial) {
+        for (const auto& pair : part) ++start[pair.left + 1];
+    }
+    for (size_t i = 0; i < left.size(); ++i) {
+        start[i + 1] += start[i];
+    }
+    std::vector<IndexPair> pairs(start.back());
+    for (auto& part : partial) {
+        for (const auto& pair : part) pairs[start[pair.left]++] = pair;
+        std::vector<IndexPair>().swap(part);
+    }
+    return pairs;
+}
+
+template<class T>
+std::vector<IndexPair> knnJoin(const Array<std::shared_ptr<Figure<T>>>& left,
+                               const Array<std::shared_ptr<Figure<T>>>& right, size_t k) {
+    return knnJoin(centroids(left), CentroidTree(centroids(right)), k);
+}
+
+template<class T>
+std::vector<IndexPair> knnJoin(const FigureBuffer<T>& left, const FigureBuffer<T>& right, size_t k) {
+    return knnJoin(centroids(left), CentroidTree(centroids(right)), k);
+}
+
+template<class T>
+std::vector<IndexPair> radiusJoin(const Array<std::shared_ptr<Figure<T>>>& left,
+                                  const Array<std::shared_ptr<Figure<T>>>& right, double radius) {
+    return radiusJoin(centroids(left), CentroidTree(centroids(right)), radius);
+}
+
+template<class T>
+std::vector<IndexPair> radiusJoin(const FigureBuffer<T>& left, const FigureBuffer<T>& right, double radius) {
+    return radiusJoin(centroids(left), CentroidTree(centroids(right)), radius);
+}
@@ -0,0 +1,351 @@
+#pragma once
+#include "array.h"
+#include "figure_buffer.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+// Переиспользование объектов без блокировок. Освобождённый объект попадает
+// в список текущего потока; излишки пачками по BatchSize уходят в общий
+// стек (push через CAS). Поток с пустым списком забирает весь стек одной
+// операцией exchange и расходует пачки сам: снятия по одному узлу нет,
+// поэтому нет и проблемы ABA. Tag различает независимые стеки.
+//
+// Удержание памяти: объекты не возвращаются системе автоматически. Список
+// потока при его завершении переходит в общий стек, и всё, что лежит в общем
+// стеке, остаётся выделенным, пока его не заберёт другой поток или пока не
+// вызван trim() (FigurePool<F>::trim, BlockCache<Size>::trim). Сам стек
+// намеренно не удаляется, чтобы потоки, завершающиеся после main, могли в
+// него вернуть свои списки; без trim() объём удерживаемой памяти ограничен
+// пиковым числом одновременно живых объектов.
+
+struct RecyclingStats {
+    size_t batchesPushed = 0; // пачек отдано в общий стек
+    size_t batchesTaken = 0;  // цепочек пачек забрано из общего стека
+};
+
+template<class Tag, class P>
+class RecyclingStack {
+public:
+    static constexpr size_t BatchSize = 64;
+
+private:
+    struct Batch {
+        Batch* next = nullptr;
+        size_t count = 0;
+        std::array<P, BatchSize> items;
+    };
+
+    struct LocalCache {
+        std::vector<P> items;
+        Batch* chain = nullptr;      // забранные из общего стека пачки
+        std::vector<Batch*> spares;  // пустые узлы для следующих пачек
+
+        ~LocalCache() {
+            RecyclingStack& stack = instance();
+            while (!items.empty()) {
+                stack.pushBatch(*this);
+            }
+            if (chain) {
+                Batch* last = chain;
+                while (last->next) last = last->next;
+                stack.splice(chain, last);
+            }
+            for (Batch* spare : spares) {
+                delete spare;
+            }
+            destroyed() = true;
+        }
+    };
+
+    std::atomic<Batch*> head{nullptr};
+    std::atomic<size_t> batchesPushed{0};
+    std::atomic<size_t> batchesTaken{0};
+
+    RecyclingStack() = default;
+
+    static LocalCache& local() {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    // После завершения потока его список недоступен: объекты освобождает вызывающий
+    static bool& destroyed() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    // До BatchSize объектов с конца списка потока — в общий стек
+    void pushBatch(LocalCache& cache) {
+        Batch* batch;
+        if (cache.spares.empty()) {
+            batch = new Batch;
+        } else {
+            batch = cache.spares.back();
+            cache.spares.pop_back();
+        }
+        batch->count = std::min(BatchSize, cache.items.size());
+        std::copy(cache.items.end() - batch->count, cache.items.end(), batch->items.begin());
+        cache.items.resize(cache.items.size() - batch->count);
+        splice(batch, batch);
+        batchesPushed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Цепочка first..last кладётся на вершину стека одной CAS
+    void splice(Batch* first, Batch* last) {
+        Batch* top = head.load(std::memory_order_relaxed);
+        do {
+            last->next = top;
+        } while (!head.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    bool refill(LocalCache& cache) {
+        if (!cache.chain) {
+            cache.chain = head.exchange(nullptr, std::memory_order_acquire);
+            if (!cache.chain) return false;
+            batchesTaken.fetch_add(1, std::memory_order_relaxed);
+        }
+        Batch* batch = cache.chain;
+        cache.chain = batch->next;
+        cache.items.insert(cache.items.end(), batch->items.begin(), batch->items.begin() + batch->count);
+        if (cache.spares.size() < BatchSize) {
+            cache.spares.push_back(batch);
+        } else {
+            delete batch;
+        }
+        return true;
+    }
+
+public:
+    RecyclingStack(const RecyclingStack&) = delete;
+    RecyclingStack& operator=(const RecyclingStack&) = delete;
+
+    // Не удаляется никогда (см. удержание памяти выше)
+    static RecyclingStack& instance() {
+        static RecyclingStack* stack = new RecyclingStack;
+        return *stack;
+    }
+
+    // Свободный объект или nullptr
+    P pop() {
+        if (destroyed()) return nullptr;
+        LocalCache& cache = local();
+        if (cache.items.empty() && !refill(cache)) {
+            return nullptr;
+        }
+        P item = cache.items.back();
+        cache.items.pop_back();
+        return item;
+    }
+
+    // false — список потока уже уничтожен, объект нужно освободить самому
+    bool push(P item) {
+        if (destroyed()) return false;
+        LocalCache& cache = local();
+        cache.items.push_back(item);
+        if (cache.items.size() >= 2 * BatchSize) {
+            pushBatch(cache);
+        }
+        return true;
+    }
+
+    // Освобождает объекты общего стека через dispose (списки потоков не трогает);
+    // возвращает число освобождённых объектов
+    template<class Dispose>
+    size_t trim(Dispose dispose) {
+        size_t disposed = 0;
+        Batch* batch = head.exchange(nullptr, std::memory_order_acquire);
+        while (batch) {
+            for (size_t i = 0; i < batch->count; ++i) {
+                dispose(batch->items[i]);
+            }
+            disposed += batch->count;
+            Batch* next = batch->next;
+            delete batch;
+            batch = next;
+        }
+        return disposed;
+    }
+
+    size_t localSize() const { return destroyed() ? 0 : local().items.size(); }
+
+    RecyclingStats stats() const {
+        RecyclingStats s;
+        s.batchesPushed = batchesPushed.load(std::memory_order_relaxed);
+        s.batchesTaken = batchesTaken.load(std::memory_order_relaxed);
+        return s;
+    }
+};
+
+struct FigurePoolStats {
+    size_t created = 0;       // объектов выделено через new
+    size_t batchesPushed = 0; // пачек отдано в общий стек
+    size_t batchesTaken = 0;  // цепочек пачек забрано из общего стека
+};
+
+// Пул объектов-фигур одного типа: фигура возвращается в пул вместе со
+// своими вершинами, и новые координаты записываются в уже выделенные точки.
+template<class F>
+class FigurePool {
+private:
+    using Stack = RecyclingStack<F, F*>;
+    std::atomic<size_t> created{0};
+
+    FigurePool() = default;
+
+public:
+    static constexpr size_t BatchSize = Stack::BatchSize;
+
+    FigurePool(const FigurePool&) = delete;
+    FigurePool& operator=(const FigurePool&) = delete;
+
+    static FigurePool& instance() {
+        static FigurePool* pool = new FigurePool;
+        return *pool;
+    }
+
+    // Свободный объект со старыми координатами или новый F()
+    F* acquire() {
+        if (F* figure = Stack::instance().pop()) {
+            return figure;
+        }
+        created.fetch_add(1, std::memory_order_relaxed);
+        return new F();
+    }
+
+    void release(F* figure) {
+        if (!Stack::instance().push(figure)) {
+            delete figure;
+        }
+    }
+
+    // Фигура с заданными вершинами под shared_ptr, который вернёт её в пул
+    template<class... Points>
+    std::shared_ptr<F> make(const Points&... points);
+
+    // Копия source без выделения памяти под вершины
+    std::shared_ptr<F> make(const F& source);
+
+    // Удаляет объекты общего стека (списки потоков не трогает)
+    size_t trim() {
+        return Stack::instance().trim([](F* figure) { delete figure; });
+    }
+
+    size_t localSize() const { return Stack::instance().localSize(); }
+
+    FigurePoolStats stats() const {
+        RecyclingStats stack = Stack::instance().stats();
+        FigurePoolStats s;
+        s.created = created.load(std::memory_order_relaxed);
+        s.batchesPushed = stack.batchesPushed;
+        s.batchesTaken = stack.batchesTaken;
+        return s;
+    }
+};
+
+// Блоки управления shared_ptr одного размера переиспользуются так же, как фигуры
+template<size_t Size>
+struct BlockTag {};
+
+template<size_t Size>
+struct BlockCache {
+    using Stack = RecyclingStack<BlockTag<Size>, void*>;
+
+    static void* allocate() {
+        if (void* block = Stack::instance().pop()) {
+            return block;
+        }
+        return ::operator new(Size);
+    }
+
+    static void deallocate(void* block) {
+        if (!Stack::instance().push(block)) {
+            ::operator delete(block);
+        }
+    }
+
+    // Возвращает системе блоки общего стека, в том числе оставленные завершившимися потоками
+    static size_t trim() {
+        return Stack::instance().trim([](void* block) { ::operator delete(block); });
+    }
+};
+
+template<class U>
+struct PoolAllocator {
+    using value_type = U;
+
+    PoolAllocator() = default;
+    template<class V>
+    PoolAllocator(const PoolAllocator<V>&) {}
+
+    U* allocate(size_t n) {
+        if (n != 1) return static_cast<U*>(::operator new(n * sizeof(U)));
+        return static_cast<U*>(BlockCache<sizeof(U)>::allocate());
+    }
+
+    void deallocate(U* p, size_t n) {
+        if (n != 1) {
+            ::operator delete(p);
+            return;
+        }
+        BlockCache<sizeof(U)>::deallocate(p);
+    }
+
+    template<class V>
+    bool operator==(const PoolAllocator<V>&) const { return true; }
+    template<class V>
+    bool operator!=(const PoolAllocator<V>&) const { return false; }
+};
+
+template<class F>
+struct PoolDeleter {
+    void operator()(F* figure) const { FigurePool<F>::instance().release(figure); }
+};
+
+template<class F>
+template<class... Points>
+std::shared_ptr<F> FigurePool<F>::make(const Points&... points) {
+    // Объект из пула хранит вершины прежнего владельца: задать нужно все
+    static_assert(sizeof...(Points) == F::VertexCount, "Point count must match the figure's vertex count");
+    F* figure = acquire();
+    size_t index = 0;
+    (figure->setVertex(index++, points), ...);
+    return std::shared_ptr<F>(figure, PoolDeleter<F>(), PoolAllocator<F>());
+}
+
+template<class F>
+std::shared_ptr<F> FigurePool<F>::make(const F& source) {
+    F* figure = acquire();
+    *figure = source;
+    return std::shared_ptr<F>(figure, PoolDeleter<F>(), PoolAllocator<F>());
+}
+
+// Пул-аналог makeFigure: фигура по упакованным координатам
+template<class T>
+std::shared_ptr<Figure<T>> makePooledFigure(FigureKind kind, const T* xy) {
+    auto p = [xy](size_t v) { return Point<T>(xy[2 * v], xy[2 * v + 1]); };
+    switch (kind) {
+    case FigureKind::Rhombus:
+        return FigurePool<Rhombus<T>>::instance().make(p(0), p(1), p(2), p(3));
+    case FigureKind::Pentagon:
+        return FigurePool<Pentagon<T>>::instance().make(p(0), p(1), p(2), p(3), p(4));
+    case FigureKind::Hexagon:
+        return FigurePool<Hexagon<T>>::instance().make(p(0), p(1), p(2), p(3), p(4), p(5));
+    }
+    throw std::invalid_argument("Unknown figure kind");
+}
+
+template<class T>
+Array<std::shared_ptr<Figure<T>>> toPooledArray(const FigureBuffer<T>& buffer) {
+    Array<std::shared_ptr<Figure<T>>> figures;
+    figures.reserve(buffer.size());
+    buffer.forEach(0, buffer.size(), [&](size_t, FigureKind kind, const T* xy) {
+        figures.push_back(makePooledFigure(kind, xy));
+    });
+    return figures;
+}
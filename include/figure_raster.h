@@ -0,0 +1,354 @@
+#pragma once
+#include "array.h"
+#include "figure_buffer.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Растеризация выпуклых фигур в сетку покрытия. Значение ячейки — сумма
+// долей её площади, покрытых фигурами (или число фигур, покрывающих центр
+// ячейки, без сглаживания). Сетка хранится плитками TileSize x TileSize,
+// каждая плитка обрабатывается одним потоком целиком и помещается в кэш.
+
+struct GridSpec {
+    double minX = 0;
+    double minY = 0;
+    double cellSize = 1;
+    size_t width = 0;
+    size_t height = 0;
+};
+
+enum class RasterMode {
+    AntiAliased, // точная доля площади ячейки
+    Binary       // 1, если центр ячейки внутри фигуры
+};
+
+class CoverageGrid {
+public:
+    static constexpr size_t TileSize = 64;
+
+private:
+    GridSpec spec;
+    size_t tilesX = 0, tilesY = 0;
+    std::vector<std::unique_ptr<float[]>> tiles; // не выделена — покрытие нулевое
+
+public:
+    CoverageGrid() = default;
+
+    explicit CoverageGrid(const GridSpec& spec)
+        : spec(spec), tilesX((spec.width + TileSize - 1) / TileSize), tilesY((spec.height + TileSize - 1) / TileSize),
+          tiles(tilesX * tilesY) {
+        if (spec.cellSize <= 0) {
+            throw std::invalid_argument("Cell size must be positive");
+        }
+    }
+
+    const GridSpec& getSpec() const { return spec; }
+    size_t width() const { return spec.width; }
+    size_t height() const { return spec.height; }
+    size_t tileColumns() const { return tilesX; }
+    size_t tileRows() const { return tilesY; }
+    size_t tileCount() const { return tiles.size(); }
+
+    float at(size_t x, size_t y) const {
+        if (x >= spec.width || y >= spec.height) {
+            throw std::out_of_range("Index out of range");
+        }
+        const auto& tile = tiles[(y / TileSize) * tilesX + x / TileSize];
+        return tile ? tile[(y % TileSize) * TileSize + x % TileSize] : 0.0f;
+    }
+
+    const float* tileData(size_t tile) const { return tiles[tile].get(); }
+
+    // Выделяет плитку при первом обращении; вызывать из потока, владеющего плиткой
+    float* tileForWrite(size_t tile) {
+        if (!tiles[tile]) {
+            tiles[tile] = std::make_unique<float[]>(TileSize * TileSize);
+        }
+        return tiles[tile].get();
+    }
+
+    size_t allocatedTiles() const {
+        return static_cast<size_t>(std::count_if(tiles.begin(), tiles.end(), [](const auto& t) { return t != nullptr; }));
+    }
+
+    // Сумма значений в единицах площади ячейки
+    double total() const {
+        double sum = 0;
+        for (const auto& tile : tiles) {
+            if (!tile) continue;
+            for (size_t i = 0; i < TileSize * TileSize; ++i) {
+                sum += tile[i];
+            }
+        }
+        return sum;
+    }
+};
+
+namespace raster_detail {
+
+struct Vertex {
+    double x, y;
+};
+
+// Отсечение выпуклого многоугольника полуплоскостью a*x + b*y <= c (Сазерленд — Ходжмен)
+inline size_t clipHalfPlane(const Vertex* in, size_t n, Vertex* out, double a, double b, double c) {
+    size_t m = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex& p = in[i];
+        const Vertex& q = in[(i + 1) % n];
+        double dp = a * p.x + b * p.y - c;
+        double dq = a * q.x + b * q.y - c;
+        if (dp <= 0) out[m++] = p;
+        if ((dp < 0 && dq > 0) || (dp > 0 && dq < 0)) {
+            double t = dp / (dp - dq);
+            out[m++] = {p.x + t * (q.x - p.x), p.y + t * (q.y - p.y)};
+        }
+    }
+    return m;
+}
+
+// Отсечение прямоугольником [x0, x1] x [y0, y1]; до 6 + 4 вершин
+inline size_t clipRect(Vertex* poly, size_t n, double x0, double y0, double x1, double y1) {
+    Vertex tmp[16];
+    n = clipHalfPlane(poly, n, tmp, -1, 0, -x0);
+    n = clipHalfPlane(tmp, n, poly, 1, 0, x1);
+    n = clipHalfPlane(poly, n, tmp, 0, -1, -y0);
+    n = clipHalfPlane(tmp, n, poly, 0, 1, y1);
+    // Точки пересечения могут выйти за границу на ulp
+    for (size_t v = 0; v < n; ++v) {
+        poly[v].x = std::min(std::max(poly[v].x, x0), x1);
+        poly[v].y = std::min(std::max(poly[v].y, y0), y1);
+    }
+    return n;
+}
+
+// Накопление знаковых площадей рёбер (как в растеризаторах шрифтов):
+// после префиксной суммы по строке |acc| — точная доля покрытия ячейки.
+// acc имеет stride столбцов (не меньше ширины + 2), координаты в [0, width] x [0, height].
+inline void accumulateEdge(float* acc, size_t stride, Vertex p0, Vertex p1) {
+    if (p0.y == p1.y) return;
+    double dir = 1;
+    if (p0.y > p1.y) {
+        std::swap(p0, p1);
+        dir = -1;
+    }
+    double dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+    double lo = std::min(p0.x, p1.x), hi = std::max(p0.x, p1.x);
+    double x = p0.x;
+    for (size_t row = static_cast<size_t>(p0.y); static_cast<double>(row) < p1.y; ++row) {
+        float* line = acc + row * stride;
+        double top = std::max(static_cast<double>(row), p0.y);
+        double bottom = std::min(static_cast<double>(row + 1), p1.y);
+        double dy = bottom - top;
+        // Накопленное округление не должно выводить x за концы ребра и за пределы acc
+        double xNext = bottom == p1.y ? p1.x : std::min(hi, std::max(lo, x + dxdy * dy));
+        double d = dy * dir;
+        double xa = std::min(x, xNext), xb = std::max(x, xNext);
+        double xaFloor = std::floor(xa);
+        size_t ia = static_cast<size_t>(xaFloor);
+        double xbCeil = std::ceil(xb);
+        size_t ib = static_cast<size_t>(xbCeil);
+
+        if (ib <= ia + 1) {
+            // Ребро в пределах одного столбца: доля справа от средней точки
+            double mid = 0.5 * (x + xNext) - xaFloor;
+            line[ia] += static_cast<float>(d - d * mid);
+            line[ia + 1] += static_cast<float>(d * mid);
+        } else {
+            double s = 1.0 / (xb - xa);
+            double fa = xa - xaFloor;
+            double a0 = 0.5 * s * (1 - fa) * (1 - fa);
+            double fb = xb - xbCeil + 1;
+            double am = 0.5 * s * fb * fb;
+            line[ia] += static_cast<float>(d * a0);
+            if (ib == ia + 2) {
+                line[ia + 1] += static_cast<float>(d * (1 - a0 - am));
+            } else {
+                double a1 = s * (1.5 - fa);
+                line[ia + 1] += static_cast<float>(d * (a1 - a0));
+                for (size_t i = ia + 2; i + 1 < ib; ++i) {
+                    line[i] += static_cast<float>(d * s);
+                }
+                double a2 = a1 + static_cast<double>(ib - ia - 3) * s;
+                line[ib - 1] += static_cast<float>(d * (1 - a2 - am));
+            }
+            line[ib] += static_cast<float>(d * am);
+        }
+        x = xNext;
+    }
+}
+
+// Рабочие буферы одного потока для плитки
+struct TileScratch {
+    static constexpr size_t Stride = CoverageGrid::TileSize + 2;
+    std::vector<float> acc = std::vector<float>(Stride * (CoverageGrid::TileSize + 1), 0.0f);
+};
+
+// Один многоугольник (в координатах плитки, уже отсечённый ею) в coverage плитки
+inline void rasterizeInTile(const Vertex* poly, size_t n, float* coverage, TileScratch& scratch, RasterMode mode) {
+    const size_t tile = CoverageGrid::TileSize;
+    double minX = poly[0].x, maxX = poly[0].x, minY = poly[0].y, maxY = poly[0].y;
+    for (size_t v = 1; v < n; ++v) {
+        minX = std::min(minX, poly[v].x);
+        maxX = std::max(maxX, poly[v].x);
+        minY = std::min(minY, poly[v].y);
+        maxY = std::max(maxY, poly[v].y);
+    }
+    size_t x0 = static_cast<size_t>(minX), y0 = static_cast<size_t>(minY);
+    size_t x1 = std::min(tile, static_cast<size_t>(std::ceil(maxX)));
+    size_t y1 = std::min(tile, static_cast<size_t>(std::ceil(maxY)));
+
+    if (mode == RasterMode::Binary) {
+        // Пересечение горизонтали через центры ячеек строки с выпуклым многоугольником
+        for (size_t row = y0; row < y1; ++row) {
+            double cy = row + 0.5;
+            double left = tile, right = -1;
+            for (size_t v = 0; v < n; ++v) {
+                const Vertex& p = poly[v];
+                const Vertex& q = poly[(v + 1) % n];
+                if ((p.y <= cy && q.y > cy) || (q.y <= cy && p.y > cy)) {
+                    double x = p.x + (cy - p.y) / (q.y - p.y) * (q.x - p.x);
+                    left = std::min(left, x);
+                    right = std::max(right, x);
+                }
+            }
+            // Центр ячейки col + 0.5 внутри [left, right)
+            double first = std::ceil(left - 0.5), last = std::ceil(right - 0.5);
+            for (double col = std::max(first, 0.0); col < last && col < tile; ++col) {
+                coverage[row * tile + static_cast<size_t>(col)] += 1.0f;
+            }
+        }
+        return;
+    }
+
+    float* acc = scratch.acc.data();
+    const size_t stride = TileScratch::Stride;
+    for (size_t v = 0; v < n; ++v) {
+        accumulateEdge(acc, stride, poly[v], poly[(v + 1) % n]);
+    }
+    for (size_t row = y0; row < y1; ++row) {
+        float* line = acc + row * stride;
+        float* out = coverage + row * tile;
+        float sum = 0;
+        for (size_t col = x0; col < x1; ++col) {
+            sum += line[col];
+            out[col] += std::min(1.0f, std::abs(sum));
+            line[col] = 0;
+        }
+        for (size_t col = x1; col < x1 + 2 && col < stride; ++col) {
+            line[col] = 0;
+        }
+    }
+}
+
+} // namespace raster_detail
+
+// Растеризует фигуры буфера в grid. Фигуры раскладываются по плиткам,
+// которых касается их прямоугольник, затем плитки обрабатываются
+// параллельно: каждую пишет ровно один поток, синхронизации нет.
+template<class T>
+void rasterize(const FigureBuffer<T>& buffer, CoverageGrid& grid, RasterMode mode = RasterMode::AntiAliased) {
+    using namespace raster_detail;
+    const GridSpec& spec = grid.getSpec();
+    const size_t tile = CoverageGrid::TileSize;
+    const size_t figures = buffer.size();
+    const double scale = 1.0 / spec.cellSize;
+
+    // Диапазон плиток каждой фигуры; пустой, если фигура вне сетки
+    std::vector<uint32_t> ranges(4 * figures);
+    std::vector<uint64_t> offsets(figures);
+    size_t offset = 0;
+    for (size_t i = 0; i < figures; ++i) {
+        offsets[i] = offset;
+        offset += 2 * vertexCountOf(buffer.kind(i));
+    }
+    parallelFor(figures, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            const T* xy = buffer.coordData() + offsets[i];
+            double minX = xy[0], maxX = xy[0], minY = xy[1], maxY = xy[1];
+            for (size_t v = 1; v < vertexCountOf(buffer.kind(i)); ++v) {
+                minX = std::min<double>(minX, xy[2 * v]);
+                maxX = std::max<double>(maxX, xy[2 * v]);
+                minY = std::min<double>(minY, xy[2 * v + 1]);
+                maxY = std::max<double>(maxY, xy[2 * v + 1]);
+            }
+            double gx0 = (minX - spec.minX) * scale, gx1 = (maxX - spec.minX) * scale;
+            double gy0 = (minY - spec.minY) * scale, gy1 = (maxY - spec.minY) * scale;
+            uint32_t* r = &ranges[4 * i];
+            if (!(gx1 > 0 && gy1 > 0 && gx0 < spec.width && gy0 < spec.height)) {
+                r[0] = r[1] = r[2] = r[3] = 0;
+                continue;
+            }
+            r[0] = static_cast<uint32_t>(std::max(0.0, gx0) / tile);
+            r[1] = static_cast<uint32_t>(std::min<double>(grid.tileColumns() - 1, gx1 / tile)) + 1;
+            r[2] = static_cast<uint32_t>(std::max(0.0, gy0) / tile);
+            r[3] = static_cast<uint32_t>(std::min<double>(grid.tileRows() - 1, gy1 / tile)) + 1;
+        }
+    });
+
+    // Раскладка по плиткам подсчётом: начало списка каждой плитки и индексы фигур
+    std::vector<uint64_t> start(grid.tileCount() + 1, 0);
+    for (size_t i = 0; i < figures; ++i) {
+        const uint32_t* r = &ranges[4 * i];
+        for (uint32_t ty = r[2]; ty < r[3]; ++ty) {
+            for (uint32_t tx = r[0]; tx < r[1]; ++tx) {
+                ++start[ty * grid.tileColumns() + tx + 1];
+            }
+        }
+    }
+    for (size_t t = 0; t < grid.tileCount(); ++t) {
+        start[t + 1] += start[t];
+    }
+    std::vector<uint32_t> binned(start.back());
+    std::vector<uint64_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < figures; ++i) {
+        const uint32_t* r = &ranges[4 * i];
+        for (uint32_t ty = r[2]; ty < r[3]; ++ty) {
+            for (uint32_t tx = r[0]; tx < r[1]; ++tx) {
+                binned[fill[ty * grid.tileColumns() + tx]++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    // Плитки разной загрузки раздаются динамически
+    std::atomic<size_t> nextTile{0};
+    size_t workers = workerCount(grid.tileCount(), 1);
+    parallelFor(workers, [&](size_t, size_t, size_t) {
+        TileScratch scratch;
+        Vertex poly[16];
+        for (size_t t = nextTile++; t < grid.tileCount(); t = nextTile++) {
+            if (start[t] == start[t + 1]) continue;
+            float* coverage = grid.tileForWrite(t);
+            double originX = static_cast<double>(t % grid.tileColumns() * tile);
+            double originY = static_cast<double>(t / grid.tileColumns() * tile);
+            double width = std::min<double>(tile, spec.width - originX);
+            double height = std::min<double>(tile, spec.height - originY);
+
+            for (uint64_t k = start[t]; k < start[t + 1]; ++k) {
+                size_t i = binned[k];
+                const T* xy = buffer.coordData() + offsets[i];
+                size_t n = vertexCountOf(buffer.kind(i));
+                for (size_t v = 0; v < n; ++v) {
+                    poly[v] = {(static_cast<double>(xy[2 * v]) - spec.minX) * scale - originX,
+                               (static_cast<double>(xy[2 * v + 1]) - spec.minY) * scale - originY};
+                }
+                n = clipRect(poly, n, 0, 0, width, height);
+                if (n >= 3) {
+                    rasterizeInTile(poly, n, coverage, scratch, mode);
+                }
+            }
+        }
+    }, 1);
+}
+
+template<class T>
+void rasterize(const Array<std::shared_ptr<Figure<T>>>& figures, CoverageGrid& grid,
+               RasterMode mode = RasterMode::AntiAliased) {
+    rasterize(FigureBuffer<T>(figures), grid, mode);
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "array.h"
+#include "figure.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include "hexagon.h"
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Воспроизводимая нагрузка для замеров, профилирования и сверки быстрых
+// путей с эталонными классами: один и тот же seed всегда даёт одну и ту же
+// последовательность фигур.
+enum class SizeDistribution {
+    Uniform,    // радиус равномерно в [minRadius, maxRadius]
+    LogUniform, // равномерно по порядку величины: много мелких и немного крупных
+    Bimodal     // половина около minRadius, половина около maxRadius
+};
+
+struct WorkloadConfig {
+    size_t figures = 1000000;
+    unsigned seed = 42;
+    double coordRange = 1000.0;
+    double minRadius = 0.1;
+    double maxRadius = 10.0;
+    std::array<double, 3> kindWeights = {1.0, 1.0, 1.0}; // ромб, пятиугольник, шестиугольник
+    SizeDistribution sizes = SizeDistribution::Uniform;
+    bool randomRotation = false;  // правильные фигуры повёрнуты на случайный угол
+    double degenerateShare = 0.0; // доля вырожденных фигур
+};
+
+namespace workload_detail {
+
+inline double sampleRadius(std::mt19937_64& rng, const WorkloadConfig& config) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    switch (config.sizes) {
+    case SizeDistribution::LogUniform:
+        return config.minRadius * std::pow(config.maxRadius / config.minRadius, unit(rng));
+    case SizeDistribution::Bimodal: {
+        double base = unit(rng) < 0.5 ? config.minRadius : config.maxRadius;
+        return base * (0.9 + 0.2 * unit(rng));
+    }
+    case SizeDistribution::Uniform:
+        break;
+    }
+    return config.minRadius + (config.maxRadius - config.minRadius) * unit(rng);
+}
+
+// Вырождение: все вершины в одной точке, совпадающие соседние вершины
+// или все вершины на одной прямой
+template<class T>
+void degenerate(std::mt19937_64& rng, std::array<Point<T>, 6>& vertices, size_t n) {
+    std::uniform_int_distribution<int> mode(0, 2);
+    switch (mode(rng)) {
+    case 0:
+        for (size_t v = 1; v < n; ++v) vertices[v] = vertices[0];
+        break;
+    case 1:
+        vertices[1] = vertices[0];
+        break;
+    default:
+        for (size_t v = 0; v < n; ++v) {
+            vertices[v] = Point<T>(vertices[v].getX(), vertices[0].getY());
+        }
+        break;
+    }
+}
+
+} // namespace workload_detail
+
+template<class T>
+std::shared_ptr<Figure<T>> generateFigure(std::mt19937_64& rng, const WorkloadConfig& config,
+                                          bool* isDegenerate = nullptr) {
+    std::uniform_real_distribution<double> coord(-config.coordRange, config.coordRange);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::discrete_distribution<int> kind(config.kindWeights.begin(), config.kindWeights.end());
+
+    int k = kind(rng);
+    double cx = coord(rng), cy = coord(rng);
+    double r = workload_detail::sampleRadius(rng, config);
+    double rotation = config.randomRotation ? 2 * M_PI * unit(rng) : 0.0;
+    bool broken = config.degenerateShare > 0 && unit(rng) < config.degenerateShare;
+    if (isDegenerate) *isDegenerate = broken;
+
+    if (!config.randomRotation && !broken) {
+        Point<T> c(static_cast<T>(cx), static_cast<T>(cy));
+        T radius = static_cast<T>(r);
+        switch (k) {
+        case 0: {
+            T half = radius / 2;
+            return std::make_shared<Rhombus<T>>(
+                Point<T>(c.getX(), c.getY() + radius), Point<T>(c.getX() + half, c.getY()),
+                Point<T>(c.getX(), c.getY() - radius), Point<T>(c.getX() - half, c.getY()));
+        }
+        case 1:
+            return std::make_shared<Pentagon<T>>(c, radius);
+        default:
+            return std::make_shared<Hexagon<T>>(c, radius);
+        }
+    }
+
+    // Вершины считаются явно: поворот и вырождение применяются к ним
+    std::array<Point<T>, 6> v;
+    size_t n = static_cast<size_t>(k) + 4;
+    for (size_t i = 0; i < n; ++i) {
+        // У ромба первая вершина сверху, а диагонали относятся как 2:1
+        double angle = rotation + 2 * M_PI * i / n + (k == 0 ? M_PI / 2 : 0.0);
+        double radius = (k == 0 && i % 2 == 1) ? r / 2 : r;
+        v[i] = Point<T>(static_cast<T>(cx + radius * std::cos(angle)),
+                        static_cast<T>(cy + radius * std::sin(angle)));
+    }
+    if (broken) {
+        workload_detail::degenerate(rng, v, n);
+    }
+    switch (k) {
+    case 0:
+        return std::make_shared<Rhombus<T>>(v[0], v[1], v[2], v[3]);
+    case 1:
+        return std::make_shared<Pentagon<T>>(v[0], v[1], v[2], v[3], v[4]);
+    default:
+        return std::make_shared<Hexagon<T>>(v[0], v[1], v[2], v[3], v[4], v[5]);
+    }
+}
+
+// degenerate, если передан, получает пометку для каждой вырожденной фигуры
+template<class T>
+Array<std::shared_ptr<Figure<T>>> generateFigures(const WorkloadConfig& config,
+                                                  std::vector<bool>* degenerate = nullptr) {
+    std::mt19937_64 rng(config.seed);
+    Array<std::shared_ptr<Figure<T>>> figures;
+    figures.reserve(config.figures);
+    if (degenerate) degenerate->assign(config.figures, false);
+    for (size_t i = 0; i < config.figures; ++i) {
+        bool broken = false;
+        figures.push_back(generateFigure<T>(rng, config, &broken));
+        if (degenerate) (*degenerate)[i] = broken;
+    }
+    return figures;
+}
@@ -2,17 +2,21 @@
 #include "figure.h"
 #include <array>
 #include <memory>
+#include <stdexcept>
 #include <cmath>
 #include <type_traits>
 
 template<class T>
 class Hexagon : public Figure<T> {
+public:
+    static constexpr size_t VertexCount = 6;
+
 private:
-    std::array<std::unique_ptr<Point<T>>, 6> vertices;
+    std::array<std::unique_ptr<Point<T>>, VertexCount> vertices;
 
-    T distance(const Point<T>& p1, const Point<T>& p2) const {
-        T dx = p1.getX() - p2.getX();
-        T dy = p1.getY() - p2.getY();
+    double distance(const Point<T>& p1, const Point<T>& p2) const {
+        double dx = static_cast<double>(p1.getX()) - p2.getX();
+        double dy = static_cast<double>(p1.getY()) - p2.getY();
         return std::sqrt(dx * dx + dy * dy);
     }
 
@@ -55,7 +59,7 @@ public:
     Hexagon& operator=(const Hexagon& other) {
         if (this != &other) {
             for (size_t i = 0; i < 6; ++i) {
-                vertices[i] = std::make_unique<Point<T>>(*other.vertices[i]);
+                *vertices[i] = *other.vertices[i];
             }
         }
         return *this;
@@ -71,7 +75,7 @@ public:
     }
 
     double area() const override {
-        T side = distance(*vertices[0], *vertices[1]);
+        double side = distance(*vertices[0], *vertices[1]);
         return (3 * std::sqrt(3) / 2) * side * side;
     }
 
@@ -96,11 +100,26 @@ public:
         for (int i = 0; i < 6; ++i) {
             T x, y;
             is >> x >> y;
-            vertices[i] = std::make_unique<Point<T>>(x, y);
+            *vertices[i] = Point<T>(x, y);
         }
     }
 
-    const Point<T>& getVertex(size_t index) const {
+    size_t vertexCount() const override {
+        return VertexCount;
+    }
+
+    const Point<T>& getVertex(size_t index) const override {
         return *vertices[index];
     }
+
+    void setVertex(size_t index, const Point<T>& point) override {
+        if (index >= VertexCount) {
+            throw std::out_of_range("Index out of range");
+        }
+        *vertices[index] = point;
+    }
+
+    size_t objectSize() const override {
+        return sizeof(*this);
+    }
 };
@@ -0,0 +1,120 @@
+#pragma once
+#include "array.h"
+#include "figure.h"
+#include "figure_buffer.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+// Оценка размера блока glibc malloc: 8 байт заголовка, выравнивание 16, минимум 32.
+inline size_t mallocBlockSize(size_t requested) {
+    return std::max<size_t>(32, (requested + 8 + 15) & ~size_t(15));
+}
+
+// Размер управляющего блока shared_ptr, созданного через make_shared
+// (указатель на vtable и два счётчика; объект хранится в том же блоке).
+constexpr size_t sharedControlBlockSize = sizeof(void*) + 2 * sizeof(int);
+
+struct MemoryFootprint {
+    size_t figures = 0;
+    size_t figureObjects = 0;     // объекты фигур вместе с указателями на vtable
+    size_t vtablePointers = 0;    // доля figureObjects
+    size_t vertexHeap = 0;        // отдельные выделения Point под каждую вершину
+    size_t controlBlocks = 0;
+    size_t allocatorOverhead = 0; // заголовки и выравнивание malloc
+    size_t arrayBuffer = 0;       // занятая часть буфера Array
+    size_t arraySlack = 0;        // незанятая ёмкость буфера Array
+
+    size_t total() const {
+        return figureObjects + vertexHeap + controlBlocks + allocatorOverhead + arrayBuffer + arraySlack;
+    }
+
+    double bytesPerFigure() const {
+        return figures == 0 ? 0.0 : static_cast<double>(total()) / figures;
+    }
+
+    MemoryFootprint& operator+=(const MemoryFootprint& other) {
+        figures += other.figures;
+        figureObjects += other.figureObjects;
+        vtablePointers += other.vtablePointers;
+        vertexHeap += other.vertexHeap;
+        controlBlocks += other.controlBlocks;
+        allocatorOverhead += other.allocatorOverhead;
+        arrayBuffer += other.arrayBuffer;
+        arraySlack += other.arraySlack;
+        return *this;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const MemoryFootprint& m) {
+        return os << "figures: " << m.figures
+                  << ", objects: " << m.figureObjects << " (vptr " << m.vtablePointers << ")"
+                  << ", vertices: " << m.vertexHeap
+                  << ", control blocks: " << m.controlBlocks
+                  << ", malloc overhead: " << m.allocatorOverhead
+                  << ", array: " << m.arrayBuffer << " + slack " << m.arraySlack
+                  << ", total: " << m.total() << " bytes";
+    }
+};
+
+// Фигура, созданная через make_shared: один блок под объект и управляющий
+// блок плюс по одному выделению на каждую вершину.
+template<class T>
+MemoryFootprint figureFootprint(const Figure<T>& figure) {
+    MemoryFootprint m;
+    m.figures = 1;
+    m.figureObjects = figure.objectSize();
+    m.vtablePointers = sizeof(void*);
+    m.controlBlocks = sharedControlBlockSize;
+
+    size_t combined = m.figureObjects + m.controlBlocks;
+    m.allocatorOverhead = mallocBlockSize(combined) - combined;
+
+    size_t vertices = figure.vertexCount();
+    m.vertexHeap = vertices * sizeof(Point<T>);
+    m.allocatorOverhead += vertices * (mallocBlockSize(sizeof(Point<T>)) - sizeof(Point<T>));
+    return m;
+}
+
+// Каждый элемент массива считается отдельной фигурой, даже если
+// несколько элементов указывают на один объект.
+template<class T>
+MemoryFootprint memoryFootprint(const Array<std::shared_ptr<Figure<T>>>& array) {
+    MemoryFootprint m;
+    for (const auto& figure : array) {
+        if (figure) {
+            m += figureFootprint(*figure);
+        }
+    }
+    m.arrayBuffer = array.size() * sizeof(std::shared_ptr<Figure<T>>);
+    m.arraySlack = (array.capacity() - array.size()) * sizeof(std::shared_ptr<Figure<T>>);
+    if (array.capacity() > 0) {
+        size_t buffer = array.capacity() * sizeof(std::shared_ptr<Figure<T>>);
+        m.allocatorOverhead += mallocBlockSize(buffer) - buffer;
+    }
+    return m;
+}
+
+struct CompactReport {
+    size_t bytesBefore = 0;
+    size_t bytesAfter = 0;
+
+    size_t saved() const { return bytesBefore > bytesAfter ? bytesBefore - bytesAfter : 0; }
+    double ratio() const { return bytesAfter == 0 ? 0.0 : static_cast<double>(bytesBefore) / bytesAfter; }
+
+    friend std::ostream& operator<<(std::ostream& os, const CompactReport& r) {
+        return os << "before: " << r.bytesBefore << " bytes, after: " << r.bytesAfter
+                  << " bytes, saved: " << r.saved() << " bytes (x" << r.ratio() << ")";
+    }
+};
+
+// Переводит коллекцию в плотное представление FigureBuffer.
+template<class T>
+FigureBuffer<T> compact(const Array<std::shared_ptr<Figure<T>>>& array, CompactReport* report = nullptr) {
+    FigureBuffer<T> buffer(array);
+    buffer.shrink_to_fit();
+    if (report) {
+        report->bytesBefore = memoryFootprint(array).total();
+        report->bytesAfter = buffer.memoryUsage();
+    }
+    return buffer;
+}
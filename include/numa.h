@@ -0,0 +1,332 @@
+#pragma once
+#ifdef __linux__
+#include "figure_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <dirent.h>
+#include <fstream>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+// Размещение коллекций по узлам NUMA без libnuma: страницы получают узел
+// по первому касанию, поэтому их заполняют потоки, закреплённые за нужным
+// узлом. Топология читается из sysfs или задаётся вручную для тестов.
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+struct NumaTopology {
+    std::vector<std::vector<int>> nodeCpus;
+
+    size_t nodeCount() const { return nodeCpus.size(); }
+
+    // Узлы из <root>/nodeN/cpulist; без sysfs — один узел со всеми процессорами
+    static NumaTopology detect(const std::string& root = "/sys/devices/system/node") {
+        NumaTopology topology;
+        if (DIR* dir = opendir(root.c_str())) {
+            std::vector<int> nodes;
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                    name.find_first_not_of("0123456789", 4) == std::string::npos) {
+                    nodes.push_back(std::stoi(name.substr(4)));
+                }
+            }
+            closedir(dir);
+            std::sort(nodes.begin(), nodes.end());
+            for (int node : nodes) {
+                std::ifstream in(root + "/node" + std::to_string(node) + "/cpulist");
+                std::string list;
+                std::getline(in, list);
+                std::vector<int> cpus = parseCpuList(list);
+                if (!cpus.empty()) {
+                    topology.nodeCpus.push_back(cpus);
+                }
+            }
+        }
+        if (topology.nodeCpus.empty()) {
+            return fake(1, std::max(1u, std::thread::hardware_concurrency()));
+        }
+        return topology;
+    }
+
+    // Искусственная топология: процессоры нумеруются подряд по модулю числа ядер
+    static NumaTopology fake(size_t nodes, size_t cpusPerNode) {
+        NumaTopology topology;
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t node = 0; node < nodes; ++node) {
+            std::vector<int> cpus;
+            for (size_t i = 0; i < cpusPerNode; ++i) {
+                cpus.push_back(static_cast<int>((node * cpusPerNode + i) % hw));
+            }
+            topology.nodeCpus.push_back(cpus);
+        }
+        return topology;
+    }
+};
+
+inline bool pinCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Узел, на котором находится страница с адресом p, или -1, если ядро не сообщает
+inline int pageNode(const void* p) {
+    void* pages[1] = {const_cast<void*>(p)};
+    int status[1] = {-1};
+    if (syscall(SYS_move_pages, 0, 1, pages, nullptr, status, 0) != 0) {
+        return -1;
+    }
+    return status[0];
+}
+
+// Запускает по потоку на каждый процессор каждого узла: fn(node, thread, threadsOnNode)
+template<class F>
+void runPinnedPerNode(const NumaTopology& topology, size_t threadsPerNode, F fn) {
+    std::vector<std::thread> threads;
+    for (size_t node = 0; node < topology.nodeCount(); ++node) {
+        const auto& cpus = topology.nodeCpus[node];
+        size_t count = threadsPerNode == 0 ? cpus.size() : threadsPerNode;
+        for (size_t t = 0; t < count; ++t) {
+            threads.emplace_back([&, node, t, count]() {
+                pinCurrentThread(cpus[t % cpus.size()]);
+                fn(node, t, count);
+            });
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+enum class NumaPlacement {
+    Interleaved, // страницы по очереди на узлах 0, 1, ..., N-1, 0, ...
+    Partitioned  // узел k получает k-й непрерывный диапазон элементов
+};
+
+// Буфер из страниц, размещённых по узлам политикой placement.
+template<class T>
+class NumaArray {
+    static_assert(std::is_trivially_copyable<T>::value, "NumaArray holds plain data only");
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t bytes = 0;
+    std::vector<size_t> bounds; // границы диапазонов узлов в элементах
+
+public:
+    NumaArray() = default;
+
+    // nodeBounds: N + 1 границ в элементах для Partitioned; пусто — поровну
+    NumaArray(size_t size, const NumaTopology& topology, NumaPlacement placement,
+              std::vector<size_t> nodeBounds = {})
+        : size_(size), bounds(std::move(nodeBounds)) {
+        size_t nodes = topology.nodeCount();
+        if (bounds.empty()) {
+            for (size_t node = 0; node <= nodes; ++node) {
+                bounds.push_back(size * node / nodes);
+            }
+        }
+        if (bounds.size() != nodes + 1 || bounds.back() != size) {
+            throw std::invalid_argument("Node bounds do not match topology");
+        }
+
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        bytes = std::max(page, (size * sizeof(T) + page - 1) / page * page);
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        data_ = static_cast<T*>(p);
+
+        size_t pages = bytes / page;
+        auto* raw = static_cast<uint8_t*>(p);
+        runPinnedPerNode(topology, 0, [&](size_t node, size_t thread, size_t threads) {
+            if (placement == NumaPlacement::Interleaved) {
+                for (size_t pg = node + nodes * thread; pg < pages; pg += nodes * threads) {
+                    raw[pg * page] = 0;
+                }
+            } else {
+                size_t first = bounds[node] * sizeof(T) / page;
+                size_t last = node + 1 == nodes ? pages : bounds[node + 1] * sizeof(T) / page;
+                for (size_t pg = first + thread; pg < last; pg += threads) {
+                    raw[pg * page] = 0;
+                }
+            }
+        });
+    }
+
+    NumaArray(const NumaArray&) = delete;
+    NumaArray& operator=(const NumaArray&) = delete;
+
+    NumaArray(NumaArray&& other) noexcept { *this = std::move(other); }
+
+    NumaArray& operator=(NumaArray&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = other.data_;
+            size_ = other.size_;
+            bytes = other.bytes;
+            bounds = std::move(other.bounds);
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.bytes = 0;
+        }
+        return *this;
+    }
+
+    ~NumaArray() { release(); }
+
+    void release() {
+        if (data_) {
+            munmap(data_, bytes);
+            data_ = nullptr;
+        }
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Диапазон элементов, закреплённый за узлом (для Partitioned)
+    std::pair<size_t, size_t> nodeRange(size_t node) const { return {bounds[node], bounds[node + 1]}; }
+};
+
+struct NumaRunStats {
+    size_t localChunks = 0;
+    size_t remoteChunks = 0;
+};
+
+// Планировщик: потоки закреплены за узлами и берут блоки из диапазона своего
+// узла; закончив свои, помогают другим узлам (такие блоки считаются удалёнными).
+// remoteShift != 0 намеренно сдвигает диапазоны на соседний узел (для замеров).
+class NumaExecutor {
+private:
+    NumaTopology topology;
+    size_t threadsPerNode;
+
+public:
+    explicit NumaExecutor(NumaTopology topology, size_t threadsPerNode = 0)
+        : topology(std::move(topology)), threadsPerNode(threadsPerNode) {}
+
+    const NumaTopology& getTopology() const { return topology; }
+
+    // fn(node, begin, end) вызывается для блоков не длиннее chunk из nodeRanges
+    template<class F>
+    NumaRunStats run(const std::vector<std::pair<size_t, size_t>>& nodeRanges, size_t chunk, F fn,
+                     size_t remoteShift = 0) const {
+        size_t nodes = topology.nodeCount();
+        if (nodeRanges.size() != nodes || chunk == 0) {
+            throw std::invalid_argument("Node ranges do not match topology");
+        }
+        std::vector<std::atomic<size_t>> next(nodes);
+        for (size_t node = 0; node < nodes; ++node) {
+            next[node] = nodeRanges[node].first;
+        }
+        std::atomic<size_t> local{0}, remote{0};
+
+        runPinnedPerNode(topology, threadsPerNode, [&](size_t node, size_t, size_t) {
+            for (size_t step = 0; step < nodes; ++step) {
+                size_t target = (node + remoteShift + step) % nodes;
+                size_t end = nodeRanges[target].second;
+                for (;;) {
+                    size_t begin = next[target].fetch_add(chunk);
+                    if (begin >= end) break;
+                    fn(target, begin, std::min(end, begin + chunk));
+                    (target == node ? local : remote).fetch_add(1);
+                }
+            }
+        });
+        return {local.load(), remote.load()};
+    }
+};
+
+// Упакованные фигуры, разложенные по узлам: часть k (по целым блокам
+// смещений) хранится в памяти узла k.
+template<class T>
+class NumaFigureBuffer {
+private:
+    NumaArray<FigureKind> kinds;
+    NumaArray<T> coords;
+    std::vector<uint64_t> blockOffsets;
+    std::vector<std::pair<size_t, size_t>> figureRanges;
+
+public:
+    NumaFigureBuffer(const FigureBuffer<T>& buffer, const NumaTopology& topology) {
+        const size_t stride = FigureBuffer<T>::OffsetStride;
+        size_t nodes = topology.nodeCount();
+        size_t blocks = (buffer.size() + stride - 1) / stride;
+
+        std::vector<size_t> figureBounds, coordBounds;
+        for (size_t node = 0; node <= nodes; ++node) {
+            size_t figure = std::min(buffer.size(), blocks * node / nodes * stride);
+            figureBounds.push_back(figure);
+            coordBounds.push_back(buffer.coordOffset(figure));
+        }
+        for (size_t node = 0; node < nodes; ++node) {
+            figureRanges.emplace_back(figureBounds[node], figureBounds[node + 1]);
+        }
+
+        kinds = NumaArray<FigureKind>(buffer.size(), topology, NumaPlacement::Partitioned, figureBounds);
+        coords = NumaArray<T>(buffer.coordCount(), topology, NumaPlacement::Partitioned, coordBounds);
+        std::copy(buffer.kindData(), buffer.kindData() + buffer.size(), kinds.data());
+        std::copy(buffer.coordData(), buffer.coordData() + buffer.coordCount(), coords.data());
+        for (size_t b = 0; b < blocks; ++b) {
+            blockOffsets.push_back(buffer.coordOffset(b * stride));
+        }
+    }
+
+    size_t size() const { return kinds.size(); }
+    const std::vector<std::pair<size_t, size_t>>& nodeRanges() const { return figureRanges; }
+    const T* coordData() const { return coords.data(); }
+    const FigureKind* kindData() const { return kinds.data(); }
+
+    // Сумма площадей; блоки выровнены по шагу смещений, чтобы начало блока было известно
+    double totalArea(const NumaExecutor& executor, NumaRunStats* stats = nullptr, size_t remoteShift = 0) const {
+        const size_t stride = FigureBuffer<T>::OffsetStride;
+        std::mutex mutex;
+        double total = 0;
+        NumaRunStats runStats = executor.run(figureRanges, stride * 64, [&](size_t, size_t begin, size_t end) {
+            const FigureKind* k = kinds.data();
+            const T* xy = coords.data() + blockOffsets[begin / stride];
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i) {
+                sum += packedArea(k[i], xy);
+                xy += 2 * vertexCountOf(k[i]);
+            }
+            std::lock_guard<std::mutex> guard(mutex);
+            total += sum;
+        }, remoteShift);
+        if (stats) *stats = runStats;
+        return total;
+    }
+};
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Количество потоков для обработки n элементов: не больше числа ядер
+// и не меньше minChunk элементов на поток.
+inline size_t workerCount(size_t n, size_t minChunk = 4096) {
+    size_t hw = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t byWork = std::max<size_t>(1, n / std::max<size_t>(1, minChunk));
+    return std::min(hw, byWork);
+}
+
+// Делит [0, n) на непрерывные блоки и вызывает fn(begin, end, worker) в отдельных потоках.
+// Исключение из любого потока пробрасывается в вызывающий поток.
+template<class F>
+void parallelFor(size_t n, F&& fn, size_t minChunk = 4096) {
+    size_t workers = workerCount(n, minChunk);
+    if (workers <= 1) {
+        fn(size_t(0), n, size_t(0));
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(workers);
+    size_t chunk = (n + workers - 1) / workers;
+    for (size_t w = 0; w < workers; ++w) {
+        size_t begin = std::min(n, w * chunk);
+        size_t end = std::min(n, begin + chunk);
+        threads.emplace_back([&, begin, end, w]() {
+            try {
+                fn(begin, end, w);
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
@@ -10,25 +10,27 @@ private:
     T x, y;
 
 public:
-    Point(T x = 0, T y = 0) : x(x), y(y) {
+    constexpr Point(T x = 0, T y = 0) : x(x), y(y) {
         static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
     }
 
-    T getX() const { return x; }
-    T getY() const { return y; }
+    constexpr T getX() const { return x; }
+    constexpr T getY() const { return y; }
 
-    void setX(T newX) { x = newX; }
-    void setY(T newY) { y = newY; }
+    constexpr void setX(T newX) { x = newX; }
+    constexpr void setY(T newY) { y = newY; }
 
-    bool operator==(const Point& other) const {
-        if (std::is_integral<T>::value) {
+    constexpr bool operator==(const Point& other) const {
+        if constexpr (std::is_integral<T>::value) {
             return x == other.x && y == other.y;
         } else {
-            return std::abs(x - other.x) < 1e-6 && std::abs(y - other.y) < 1e-6;
+            T dx = x - other.x;
+            T dy = y - other.y;
+            return (dx < 0 ? -dx : dx) < 1e-6 && (dy < 0 ? -dy : dy) < 1e-6;
         }
     }
 
-    bool operator!=(const Point& other) const {
+    constexpr bool operator!=(const Point& other) const {
         return !(*this == other);
     }
 
@@ -0,0 +1,273 @@
+#pragma once
+#include "figure.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Адаптивная точность в духе Шевчука: сначала результат в double с
+// оценкой погрешности, и только если знак или значение не гарантированы,
+// вычисление повторяется точно на разложениях (суммах неперекрывающихся double).
+// Координаты переводятся в double; для целых T это точно при |v| < 2^53.
+
+namespace robust_detail {
+
+constexpr double epsilon = std::numeric_limits<double>::epsilon() / 2;
+constexpr double orientErrorBound = (3.0 + 16.0 * epsilon) * epsilon;
+
+inline void twoSum(double a, double b, double& sum, double& error) {
+    sum = a + b;
+    double bVirtual = sum - a;
+    double aVirtual = sum - bVirtual;
+    error = (a - aVirtual) + (b - bVirtual);
+}
+
+inline void twoProduct(double a, double b, double& product, double& error) {
+    product = a * b;
+    error = std::fma(a, b, -product);
+}
+
+// Добавляет b к разложению e (компоненты по возрастанию модуля, без нулей).
+inline void growExpansion(std::vector<double>& e, double b) {
+    double q = b;
+    size_t out = 0;
+    for (size_t i = 0; i < e.size(); ++i) {
+        double sum, error;
+        twoSum(q, e[i], sum, error);
+        q = sum;
+        if (error != 0) {
+            e[out++] = error;
+        }
+    }
+    e.resize(out);
+    if (q != 0) {
+        e.push_back(q);
+    }
+}
+
+inline void addProduct(std::vector<double>& e, double a, double b) {
+    double product, error;
+    twoProduct(a, b, product, error);
+    growExpansion(e, error);
+    growExpansion(e, product);
+}
+
+// Знак разложения определяется старшей ненулевой компонентой
+inline int expansionSign(const std::vector<double>& e) {
+    if (e.empty()) return 0;
+    return e.back() > 0 ? 1 : -1;
+}
+
+inline double expansionEstimate(const std::vector<double>& e) {
+    double sum = 0;
+    for (double component : e) {
+        sum += component;
+    }
+    return sum;
+}
+
+} // namespace robust_detail
+
+template<class T>
+double orient2dFast(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
+    return (static_cast<double>(a.getX()) - c.getX()) * (static_cast<double>(b.getY()) - c.getY()) -
+           (static_cast<double>(a.getY()) - c.getY()) * (static_cast<double>(b.getX()) - c.getX());
+}
+
+// Точный знак ориентации по разложению шести произведений
+template<class T>
+int orient2dExact(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
+    using namespace robust_detail;
+    double ax = a.getX(), ay = a.getY();
+    double bx = b.getX(), by = b.getY();
+    double cx = c.getX(), cy = c.getY();
+
+    std::vector<double> e;
+    e.reserve(16);
+    addProduct(e, ax, by);
+    addProduct(e, -ax, cy);
+    addProduct(e, -cx, by);
+    addProduct(e, -ay, bx);
+    addProduct(e, ay, cx);
+    addProduct(e, cy, bx);
+    return expansionSign(e);
+}
+
+// Решает ли оценка в double знак ориентации без точного пересчёта
+template<class T>
+bool orient2dFilterDecides(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
+    double left = (static_cast<double>(a.getX()) - c.getX()) * (static_cast<double>(b.getY()) - c.getY());
+    double right = (static_cast<double>(a.getY()) - c.getY()) * (static_cast<double>(b.getX()) - c.getX());
+    double det = left - right;
+    return std::abs(det) >= robust_detail::orientErrorBound * (std::abs(left) + std::abs(right)) && det != 0;
+}
+
+// +1 — поворот против часовой стрелки, -1 — по часовой, 0 — точки коллинеарны
+template<class T>
+int orient2d(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
+    double left = (static_cast<double>(a.getX()) - c.getX()) * (static_cast<double>(b.getY()) - c.getY());
+    double right = (static_cast<double>(a.getY()) - c.getY()) * (static_cast<double>(b.getX()) - c.getX());
+    double det = left - right;
+    double bound = robust_detail::orientErrorBound * (std::abs(left) + std::abs(right));
+    if (det > bound) return 1;
+    if (-det > bound) return -1;
+    return orient2dExact(a, b, c);
+}
+
+// Удвоенная знаковая площадь многоугольника по формуле шнурования.
+// Быстрый путь считает веер треугольников от первой вершины в разностях
+// координат и принимается, если оценка относительной погрешности не больше
+// 2^-40; иначе сумма по исходным координатам считается точно.
+template<class T>
+double signedDoubleAreaRobust(const Point<T>* vertices, size_t n) {
+    using namespace robust_detail;
+    if (n < 3) return 0;
+
+    double x0 = vertices[0].getX(), y0 = vertices[0].getY();
+    double sum = 0, magnitude = 0;
+    for (size_t i = 1; i + 1 < n; ++i) {
+        double dx1 = vertices[i].getX() - x0, dy1 = vertices[i].getY() - y0;
+        double dx2 = vertices[i + 1].getX() - x0, dy2 = vertices[i + 1].getY() - y0;
+        double left = dx1 * dy2;
+        double right = dx2 * dy1;
+        sum += left - right;
+        magnitude += std::abs(left) + std::abs(right);
+    }
+    double bound = (2 * n + 6) * epsilon * magnitude;
+    if (bound <= std::abs(sum) * std::ldexp(1.0, -40)) {
+        return sum;
+    }
+
+    std::vector<double> e;
+    e.reserve(4 * n);
+    for (size_t i = 0; i < n; ++i) {
+        const Point<T>& p = vertices[i];
+        const Point<T>& q = vertices[(i + 1) % n];
+        addProduct(e, p.getX(), q.getY());
+        addProduct(e, -static_cast<double>(q.getX()), p.getY());
+    }
+    return expansionEstimate(e);
+}
+
+// Вызывает fn(vertices, n) для вершин фигуры; до 16 вершин — без выделения памяти
+template<class T, class F>
+auto withVertices(const Figure<T>& figure, F fn) {
+    size_t n = figure.vertexCount();
+    Point<T> local[16];
+    std::vector<Point<T>> heap;
+    Point<T>* vertices = local;
+    if (n > 16) {
+        heap.resize(n);
+        vertices = heap.data();
+    }
+    for (size_t v = 0; v < n; ++v) {
+        vertices[v] = figure.getVertex(v);
+    }
+    return fn(vertices, n);
+}
+
+// Площадь многоугольника по его вершинам (а не по формуле правильной фигуры)
+template<class T>
+double robustArea(const Figure<T>& figure) {
+    return withVertices(figure, [](const Point<T>* vertices, size_t n) {
+        return std::abs(signedDoubleAreaRobust(vertices, n)) / 2;
+    });
+}
+
+// +1 — вершины перечислены против часовой стрелки, -1 — по часовой, 0 — вырожденная фигура
+template<class T>
+int robustOrientation(const Figure<T>& figure) {
+    double area = withVertices(figure, [](const Point<T>* vertices, size_t n) {
+        return signedDoubleAreaRobust(vertices, n);
+    });
+    return area > 0 ? 1 : (area < 0 ? -1 : 0);
+}
+
+// Строгая выпуклость: все остальные вершины лежат строго по одну сторону от
+// каждой стороны. Одинаковых поворотов соседних троек недостаточно: их даёт и
+// звезда, обходящая центр дважды. Проверка O(n^2), что для фигур до 6 вершин дёшево.
+template<class T>
+bool isStrictlyConvex(const Point<T>* vertices, size_t n) {
+    int expected = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Point<T>& a = vertices[i];
+        const Point<T>& b = vertices[(i + 1) % n];
+        for (size_t k = 2; k < n; ++k) {
+            int turn = orient2d(a, b, vertices[(i + k) % n]);
+            if (turn == 0 || (expected != 0 && turn != expected)) return false;
+            expected = turn;
+        }
+    }
+    return n >= 3;
+}
+
+template<class T>
+bool isStrictlyConvex(const Figure<T>& figure) {
+    return withVertices(figure, [](const Point<T>* vertices, size_t n) {
+        return isStrictlyConvex(vertices, n);
+    });
+}
+
+// Центр вершин без усечения для целых T: сумма координат точная
+template<class T>
+Point<double> robustCenter(const Figure<T>& figure) {
+    std::vector<double> sx, sy;
+    for (size_t v = 0; v < figure.vertexCount(); ++v) {
+        robust_detail::growExpansion(sx, static_cast<double>(figure.getVertex(v).getX()));
+        robust_detail::growExpansion(sy, static_cast<double>(figure.getVertex(v).getY()));
+    }
+    double n = static_cast<double>(figure.vertexCount());
+    return Point<double>(robust_detail::expansionEstimate(sx) / n, robust_detail::expansionEstimate(sy) / n);
+}
+
+namespace robust_detail {
+
+// Биты числа как целое, монотонное по значению: соседние числа отличаются на 1
+template<class F, class I>
+uint64_t ulpDistanceBits(F a, F b) {
+    if (a == b) return 0;
+    if (std::isnan(a) || std::isnan(b)) return std::numeric_limits<uint64_t>::max();
+    auto ordered = [](F v) {
+        I bits;
+        std::memcpy(&bits, &v, sizeof(v));
+        return static_cast<int64_t>(bits < 0 ? std::numeric_limits<I>::min() - bits : bits);
+    };
+    int64_t ia = ordered(a), ib = ordered(b);
+    return ia > ib ? static_cast<uint64_t>(ia) - static_cast<uint64_t>(ib)
+                   : static_cast<uint64_t>(ib) - static_cast<uint64_t>(ia);
+}
+
+} // namespace robust_detail
+
+// Расстояние между числами в ulp их собственного типа, не зависящее от масштаба
+inline uint64_t ulpDistance(double a, double b) {
+    return robust_detail::ulpDistanceBits<double, int64_t>(a, b);
+}
+
+// Для float шаг свой: после расширения до double один ulp float — это 2^29 ulp double
+inline uint64_t ulpDistance(float a, float b) {
+    return robust_detail::ulpDistanceBits<float, int32_t>(a, b);
+}
+
+template<class T>
+bool ulpEquals(const Point<T>& a, const Point<T>& b, uint64_t maxUlps = 4) {
+    if constexpr (std::is_integral<T>::value) {
+        return a.getX() == b.getX() && a.getY() == b.getY();
+    } else {
+        using F = std::conditional_t<std::is_same<T, float>::value, float, double>;
+        return ulpDistance(static_cast<F>(a.getX()), static_cast<F>(b.getX())) <= maxUlps &&
+               ulpDistance(static_cast<F>(a.getY()), static_cast<F>(b.getY())) <= maxUlps;
+    }
+}
+
+// Равенство фигур с допуском в ulp вместо абсолютного 1e-6 из Point::operator==
+template<class T>
+bool robustEquals(const Figure<T>& a, const Figure<T>& b, uint64_t maxUlps = 4) {
+    if (a.vertexCount() != b.vertexCount()) return false;
+    for (size_t v = 0; v < a.vertexCount(); ++v) {
+        if (!ulpEquals(a.getVertex(v), b.getVertex(v), maxUlps)) return false;
+    }
+    return true;
+}
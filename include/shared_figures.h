@@ -0,0 +1,330 @@
+#pragma once
+#if defined(__unix__) || defined(__APPLE__)
+#include "figure_buffer.h"
+#include "figure_bounds.h"
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+// Область POSIX shared memory с упакованными фигурами. Внутри только
+// смещения от начала области, поэтому её можно отобразить в любом процессе
+// по любому адресу без копирования. Раскладка:
+//   заголовок | виды фигур | смещения блоков | координаты | слоты результатов
+
+struct SharedRegionHeader {
+    char magic[8];
+    uint32_t typeSize;
+    uint32_t workerSlots;
+    uint64_t figureCount;
+    uint64_t coordCount;
+    uint64_t blockStride;
+    uint64_t kindsOffset;
+    uint64_t blocksOffset;
+    uint64_t coordsOffset;
+    uint64_t resultsOffset;
+    uint64_t totalSize;
+};
+
+// Итог одного рабочего процесса; процессы пишут только в свой слот.
+struct ShardResult {
+    double totalArea;
+    double sumCenterX;
+    double sumCenterY;
+    uint64_t count;
+    uint64_t perKind[3];
+    double minX, minY, maxX, maxY;
+    uint32_t done;
+};
+
+struct ShardedAggregate {
+    double totalArea = 0;
+    size_t count = 0;
+    std::array<size_t, 3> perKind = {0, 0, 0};
+    Point<double> centroid;
+    BoundingBox<double> box;
+
+    size_t countOf(FigureKind kind) const { return perKind[vertexCountOf(kind) - 4]; }
+};
+
+template<class T>
+class SharedFigureRegion {
+private:
+    std::string name;
+    uint8_t* base = nullptr;
+    size_t mappedSize = 0;
+    bool owner = false;
+
+    static size_t align(size_t value) { return (value + 63) & ~size_t(63); }
+
+    SharedFigureRegion(std::string name, uint8_t* base, size_t size, bool owner)
+        : name(std::move(name)), base(base), mappedSize(size), owner(owner) {}
+
+    static uint8_t* mapFd(int fd, size_t size) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        close(fd);
+        return static_cast<uint8_t*>(p);
+    }
+
+    template<class U>
+    const U* at(uint64_t offset) const { return reinterpret_cast<const U*>(base + offset); }
+
+public:
+    // Создаёт область name (например, "/figures") и копирует в неё буфер.
+    // Владелец удаляет имя области в деструкторе.
+    static SharedFigureRegion create(const std::string& name, const FigureBuffer<T>& buffer, size_t workerSlots) {
+        const size_t stride = FigureBuffer<T>::OffsetStride;
+        size_t figures = buffer.size();
+        size_t blocks = (figures + stride - 1) / stride;
+
+        SharedRegionHeader header{};
+        std::memcpy(header.magic, "FIGSHM1", 8);
+        header.typeSize = sizeof(T);
+        header.workerSlots = static_cast<uint32_t>(workerSlots);
+        header.figureCount = figures;
+        header.coordCount = buffer.coordCount();
+        header.blockStride = stride;
+        header.kindsOffset = align(sizeof(SharedRegionHeader));
+        header.blocksOffset = align(header.kindsOffset + figures);
+        header.coordsOffset = align(header.blocksOffset + blocks * sizeof(uint64_t));
+        header.resultsOffset = align(header.coordsOffset + header.coordCount * sizeof(T));
+        header.totalSize = header.resultsOffset + workerSlots * sizeof(ShardResult);
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        if (ftruncate(fd, static_cast<off_t>(header.totalSize)) != 0) {
+            int error = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::system_error(error, std::generic_category(), "ftruncate");
+        }
+        uint8_t* base;
+        try {
+            base = mapFd(fd, header.totalSize);
+        } catch (...) {
+            shm_unlink(name.c_str());
+            throw;
+        }
+        SharedFigureRegion region(name, base, header.totalSize, true);
+
+        std::memcpy(base, &header, sizeof(header));
+        std::memcpy(base + header.kindsOffset, buffer.kindData(), figures);
+        auto* blockOffsets = reinterpret_cast<uint64_t*>(base + header.blocksOffset);
+        for (size_t b = 0; b < blocks; ++b) {
+            blockOffsets[b] = buffer.coordOffset(b * stride);
+        }
+        std::memcpy(base + header.coordsOffset, buffer.coordData(), header.coordCount * sizeof(T));
+        std::memset(base + header.resultsOffset, 0, workerSlots * sizeof(ShardResult));
+        return region;
+    }
+
+    static SharedFigureRegion open(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedRegionHeader)) {
+            close(fd);
+            throw std::runtime_error("Not a figure region: " + name);
+        }
+        uint8_t* base = mapFd(fd, static_cast<size_t>(st.st_size));
+        SharedFigureRegion region(name, base, static_cast<size_t>(st.st_size), false);
+
+        const SharedRegionHeader& h = region.header();
+        size_t blocks = h.blockStride == 0 ? 0 : (h.figureCount + h.blockStride - 1) / h.blockStride;
+        if (std::memcmp(h.magic, "FIGSHM1", 8) != 0 || h.typeSize != sizeof(T) || h.totalSize > region.mappedSize ||
+            h.blockStride == 0 || h.kindsOffset + h.figureCount > h.blocksOffset ||
+            h.blocksOffset + blocks * sizeof(uint64_t) > h.coordsOffset ||
+            h.coordsOffset + h.coordCount * sizeof(T) > h.resultsOffset ||
+            h.resultsOffset + h.workerSlots * sizeof(ShardResult) > h.totalSize) {
+            throw std::runtime_error("Not a figure region: " + name);
+        }
+        return region;
+    }
+
+    SharedFigureRegion(const SharedFigureRegion&) = delete;
+    SharedFigureRegion& operator=(const SharedFigureRegion&) = delete;
+
+    SharedFigureRegion(SharedFigureRegion&& other) noexcept
+        : name(std::move(other.name)), base(other.base), mappedSize(other.mappedSize), owner(other.owner) {
+        other.base = nullptr;
+        other.owner = false;
+    }
+
+    ~SharedFigureRegion() {
+        if (base) {
+            munmap(base, mappedSize);
+        }
+        if (owner) {
+            shm_unlink(name.c_str());
+        }
+    }
+
+    const SharedRegionHeader& header() const { return *at<SharedRegionHeader>(0); }
+    const std::string& regionName() const { return name; }
+    size_t size() const { return header().figureCount; }
+    size_t workerSlots() const { return header().workerSlots; }
+    const FigureKind* kinds() const { return at<FigureKind>(header().kindsOffset); }
+    const T* coords() const { return at<T>(header().coordsOffset); }
+
+    ShardResult& result(size_t worker) {
+        if (worker >= workerSlots()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return reinterpret_cast<ShardResult*>(base + header().resultsOffset)[worker];
+    }
+
+    // Обход фигур [begin, end), begin кратен шагу смещений блоков: fn(index, kind, xy)
+    template<class F>
+    void forEach(size_t begin, size_t end, F fn) const {
+        const SharedRegionHeader& h = header();
+        if (begin >= end) return;
+        if (begin % h.blockStride != 0 || end > h.figureCount) {
+            throw std::out_of_range("Index out of range");
+        }
+        const FigureKind* k = kinds();
+        const T* xy = coords();
+        uint64_t offset = at<uint64_t>(h.blocksOffset)[begin / h.blockStride];
+        for (size_t i = begin; i < end; ++i) {
+            if (!isFigureKind(static_cast<size_t>(k[i])) || offset + 2 * vertexCountOf(k[i]) > h.coordCount) {
+                throw std::runtime_error("Corrupted figure region");
+            }
+            fn(i, k[i], xy + offset);
+            offset += 2 * vertexCountOf(k[i]);
+        }
+    }
+
+    // Границы части worker из workers, выровненные по блокам смещений
+    std::pair<size_t, size_t> partition(size_t worker, size_t workers) const {
+        size_t stride = header().blockStride;
+        size_t blocks = (size() + stride - 1) / stride;
+        size_t begin = std::min(size(), blocks * worker / workers * stride);
+        size_t end = std::min(size(), blocks * (worker + 1) / workers * stride);
+        return {begin, end};
+    }
+};
+
+// Работа одного процесса: агрегаты по своей части области в свой слот.
+template<class T>
+void runShardWorker(const std::string& name, size_t worker, size_t workers) {
+    SharedFigureRegion<T> region = SharedFigureRegion<T>::open(name);
+    auto range = region.partition(worker, workers);
+
+    ShardResult local{};
+    BoundingBox<double> box;
+    region.forEach(range.first, range.second, [&](size_t, FigureKind kind, const T* xy) {
+        local.totalArea += packedArea(kind, xy);
+        // Центр в double прямо по координатам: packedCenter усёк бы его для целых T
+        size_t n = vertexCountOf(kind);
+        double sumX = 0, sumY = 0;
+        for (size_t v = 0; v < n; ++v) {
+            sumX += static_cast<double>(xy[2 * v]);
+            sumY += static_cast<double>(xy[2 * v + 1]);
+            box.extend(Point<double>(xy[2 * v], xy[2 * v + 1]));
+        }
+        local.sumCenterX += sumX / n;
+        local.sumCenterY += sumY / n;
+        ++local.count;
+        ++local.perKind[n - 4];
+    });
+    local.minX = box.minX;
+    local.minY = box.minY;
+    local.maxX = box.maxX;
+    local.maxY = box.maxY;
+    local.done = 1;
+    region.result(worker) = local;
+}
+
+template<class T>
+ShardedAggregate mergeShardResults(SharedFigureRegion<T>& region, size_t workers) {
+    ShardedAggregate aggregate;
+    double sumX = 0, sumY = 0;
+    for (size_t w = 0; w < workers; ++w) {
+        const ShardResult& r = region.result(w);
+        if (!r.done) {
+            throw std::runtime_error("Shard worker " + std::to_string(w) + " did not finish");
+        }
+        aggregate.totalArea += r.totalArea;
+        aggregate.count += r.count;
+        for (size_t k = 0; k < 3; ++k) {
+            aggregate.perKind[k] += r.perKind[k];
+        }
+        sumX += r.sumCenterX;
+        sumY += r.sumCenterY;
+        if (r.count > 0) {
+            BoundingBox<double> box;
+            box.minX = r.minX;
+            box.minY = r.minY;
+            box.maxX = r.maxX;
+            box.maxY = r.maxY;
+            aggregate.box.extend(box);
+        }
+    }
+    if (aggregate.count > 0) {
+        aggregate.centroid = Point<double>(sumX / aggregate.count, sumY / aggregate.count);
+    }
+    return aggregate;
+}
+
+// Координатор: запускает workers дочерних процессов, каждый отображает
+// ту же область по её имени и обрабатывает свою часть, затем итоги сливаются.
+template<class T>
+ShardedAggregate shardedAggregate(SharedFigureRegion<T>& region, size_t workers) {
+    if (workers == 0 || workers > region.workerSlots()) {
+        throw std::invalid_argument("Worker count exceeds result slots");
+    }
+    for (size_t w = 0; w < workers; ++w) {
+        region.result(w).done = 0;
+    }
+
+    std::vector<pid_t> children;
+    for (size_t w = 0; w < workers; ++w) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            int error = errno;
+            for (pid_t child : children) {
+                waitpid(child, nullptr, 0);
+            }
+            throw std::system_error(error, std::generic_category(), "fork");
+        }
+        if (pid == 0) {
+            int status = 0;
+            try {
+                runShardWorker<T>(region.regionName(), w, workers);
+            } catch (...) {
+                status = 1;
+            }
+            _exit(status);
+        }
+        children.push_back(pid);
+    }
+
+    bool failed = false;
+    for (pid_t child : children) {
+        int status = 0;
+        if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = true;
+        }
+    }
+    if (failed) {
+        throw std::runtime_error("Shard worker failed");
+    }
+    return mergeShardResults(region, workers);
+}
+#endif
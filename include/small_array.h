@@ -0,0 +1,162 @@
+#pragma once
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+// Массив с тем же интерфейсом, что и Array, но первые N элементов
+// хранятся внутри объекта; куча используется только при size() > N.
+template<typename T, size_t N>
+class SmallArray {
+    static_assert(N > 0, "Inline capacity must be positive");
+
+private:
+    T inline_data[N];
+    std::unique_ptr<T[]> heap_data;
+    size_t size_;
+    size_t capacity_;
+
+    T* storage() { return heap_data ? heap_data.get() : inline_data; }
+    const T* storage() const { return heap_data ? heap_data.get() : inline_data; }
+
+    void resize(size_t new_capacity) {
+        auto new_data = std::make_unique<T[]>(new_capacity);
+        T* old_data = storage();
+
+        for (size_t i = 0; i < size_; ++i) {
+            new_data[i] = std::move(old_data[i]);
+        }
+
+        if (!heap_data) {
+            resetInline(0);
+        }
+        heap_data = std::move(new_data);
+        capacity_ = new_capacity;
+    }
+
+    // Ячейки за концом массива и всё встроенное хранилище при данных в куче
+    // держат T(), чтобы не продлевать жизнь удалённых элементов
+    void resetInline(size_t from) {
+        for (size_t i = from; i < N; ++i) {
+            inline_data[i] = T();
+        }
+    }
+
+    void copyFrom(const SmallArray& other) {
+        size_ = other.size_;
+        if (size_ <= N) {
+            heap_data.reset();
+            capacity_ = N;
+        } else {
+            heap_data = std::make_unique<T[]>(size_);
+            capacity_ = size_;
+        }
+        T* dst = storage();
+        const T* src = other.storage();
+        for (size_t i = 0; i < size_; ++i) {
+            dst[i] = src[i];
+        }
+        resetInline(heap_data ? 0 : size_);
+    }
+
+    void moveFrom(SmallArray&& other) noexcept {
+        size_ = other.size_;
+        if (other.heap_data) {
+            heap_data = std::move(other.heap_data);
+            capacity_ = other.capacity_;
+        } else {
+            heap_data.reset();
+            capacity_ = N;
+            for (size_t i = 0; i < size_; ++i) {
+                inline_data[i] = std::move(other.inline_data[i]);
+            }
+            other.resetInline(0);
+        }
+        resetInline(heap_data ? 0 : size_);
+        other.size_ = 0;
+        other.capacity_ = N;
+    }
+
+public:
+    SmallArray() : size_(0), capacity_(N) {}
+
+    SmallArray(const SmallArray& other) : size_(0), capacity_(N) {
+        copyFrom(other);
+    }
+
+    SmallArray(SmallArray&& other) noexcept : size_(0), capacity_(N) {
+        moveFrom(std::move(other));
+    }
+
+    SmallArray& operator=(const SmallArray& other) {
+        if (this != &other) {
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    SmallArray& operator=(SmallArray&& other) noexcept {
+        if (this != &other) {
+            moveFrom(std::move(other));
+        }
+        return *this;
+    }
+
+    void push_back(T value) {
+        if (size_ >= capacity_) {
+            resize(capacity_ * 2);
+        }
+        storage()[size_++] = std::move(value);
+    }
+
+    void erase(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        T* items = storage();
+        for (size_t i = index; i < size_ - 1; ++i) {
+            items[i] = std::move(items[i + 1]);
+        }
+        items[--size_] = T();
+    }
+
+    T& operator[](size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return storage()[index];
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return storage()[index];
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    static constexpr size_t inline_capacity() { return N; }
+
+    bool empty() const { return size_ == 0; }
+    bool is_inline() const { return !heap_data; }
+
+    void reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            resize(new_capacity);
+        }
+    }
+
+    T* begin() { return storage(); }
+    T* end() { return storage() + size_; }
+    const T* begin() const { return storage(); }
+    const T* end() const { return storage() + size_; }
+
+    void clear() {
+        T* items = storage();
+        for (size_t i = 0; i < size_; ++i) {
+            items[i] = T();
+        }
+        size_ = 0;
+    }
+};
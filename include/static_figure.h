@@ -0,0 +1,131 @@
+#pragma once
+#include "constexpr_math.h"
+#include "figure_buffer.h"
+#include "point.h"
+#include <array>
+#include <memory>
+#include <type_traits>
+
+// Многоугольник с вершинами по значению: пригоден для константных выражений,
+// поэтому шаблоны и единичные фигуры можно вычислить при компиляции.
+// Площадь считается по тем же формулам, что и у Rhombus/Pentagon/Hexagon.
+template<class T, size_t N>
+class StaticPolygon {
+    static_assert(N >= 4 && N <= 6, "Only rhombus, pentagon and hexagon layouts are supported");
+
+private:
+    std::array<Point<T>, N> vertices;
+
+    static constexpr double distance(const Point<T>& p1, const Point<T>& p2) {
+        double dx = static_cast<double>(p1.getX()) - p2.getX();
+        double dy = static_cast<double>(p1.getY()) - p2.getY();
+        return constexprSqrt(dx * dx + dy * dy);
+    }
+
+public:
+    constexpr StaticPolygon() : vertices{} {}
+
+    constexpr explicit StaticPolygon(const std::array<Point<T>, N>& points) : vertices(points) {}
+
+    // Правильный многоугольник (для N = 4 — квадрат-ромб), как в конструкторах фигур по центру и радиусу.
+    static constexpr StaticPolygon regular(const Point<T>& center, T radius, double rotation = 0) {
+        StaticPolygon polygon;
+        for (size_t i = 0; i < N; ++i) {
+            double angle = rotation + 2 * constexprPi * i / N;
+            polygon.vertices[i] = Point<T>(static_cast<T>(center.getX() + radius * constexprCos(angle)),
+                                           static_cast<T>(center.getY() + radius * constexprSin(angle)));
+        }
+        return polygon;
+    }
+
+    static constexpr size_t vertexCount() { return N; }
+
+    constexpr const Point<T>& getVertex(size_t index) const {
+        return vertices[index];
+    }
+
+    constexpr Point<double> geometricCenter() const {
+        double x = 0, y = 0;
+        for (size_t i = 0; i < N; ++i) {
+            x += vertices[i].getX();
+            y += vertices[i].getY();
+        }
+        return Point<double>(x / N, y / N);
+    }
+
+    constexpr double area() const {
+        if constexpr (N == 4) {
+            return distance(vertices[0], vertices[2]) * distance(vertices[1], vertices[3]) / 2.0;
+        } else if constexpr (N == 5) {
+            double side = distance(vertices[0], vertices[1]);
+            return 0.25 * constexprSqrt(5 * (5 + 2 * constexprSqrt(5))) * side * side;
+        } else {
+            double side = distance(vertices[0], vertices[1]);
+            return (3 * constexprSqrt(3) / 2) * side * side;
+        }
+    }
+
+    constexpr StaticPolygon translated(T dx, T dy) const {
+        StaticPolygon polygon;
+        for (size_t i = 0; i < N; ++i) {
+            polygon.vertices[i] = Point<T>(vertices[i].getX() + dx, vertices[i].getY() + dy);
+        }
+        return polygon;
+    }
+
+    constexpr bool operator==(const StaticPolygon& other) const {
+        for (size_t i = 0; i < N; ++i) {
+            if (vertices[i] != other.vertices[i]) return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<Figure<T>> toFigure() const {
+        T xy[2 * N] = {};
+        for (size_t i = 0; i < N; ++i) {
+            xy[2 * i] = vertices[i].getX();
+            xy[2 * i + 1] = vertices[i].getY();
+        }
+        return makeFigure(static_cast<FigureKind>(N), xy);
+    }
+};
+
+template<class T> using StaticRhombus = StaticPolygon<T, 4>;
+template<class T> using StaticPentagon = StaticPolygon<T, 5>;
+template<class T> using StaticHexagon = StaticPolygon<T, 6>;
+
+// Предвычисленные характеристики фигуры-шаблона
+struct ShapeStamp {
+    FigureKind kind;
+    double area;
+    double centerX;
+    double centerY;
+};
+
+template<class T, size_t N>
+constexpr ShapeStamp makeStamp(const StaticPolygon<T, N>& polygon) {
+    Point<double> center = polygon.geometricCenter();
+    return {static_cast<FigureKind>(N), polygon.area(), center.getX(), center.getY()};
+}
+
+// Площадь шаблона, масштабированного в scale раз: ядра, знающие фигуру при
+// компиляции, умножают константу вместо вычисления корней.
+template<class T, size_t N>
+constexpr double scaledArea(const StaticPolygon<T, N>& unit, double scale) {
+    return unit.area() * scale * scale;
+}
+
+inline constexpr StaticRhombus<double> unitRhombus = StaticRhombus<double>::regular(Point<double>(0, 0), 1.0);
+inline constexpr StaticPentagon<double> unitPentagon = StaticPentagon<double>::regular(Point<double>(0, 0), 1.0);
+inline constexpr StaticHexagon<double> unitHexagon = StaticHexagon<double>::regular(Point<double>(0, 0), 1.0);
+
+// Таблица единичных фигур (радиус описанной окружности 1), размещается в .rodata
+inline constexpr std::array<ShapeStamp, 3> unitShapeTable = {
+    makeStamp(unitRhombus),
+    makeStamp(unitPentagon),
+    makeStamp(unitHexagon),
+};
+
+inline constexpr const ShapeStamp& unitStamp(FigureKind kind) {
+    return unitShapeTable[vertexCountOf(kind) - 4];
+}
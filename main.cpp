@@ -7,6 +7,8 @@
 #include "include/hexagon.h"
 #include "include/array.h"
 #include "include/array_of_figures.h"
+#include "include/small_array.h"
+#include "include/figure_batch.h"
 
 
 int main() {
@@ -42,7 +44,7 @@ int main() {
         printAllFigures(figures);
         
         // Демонстрация работы с массивом конкретных типов
-        Array<std::shared_ptr<Rhombus<double>>> rhombusArray;
+        SmallArray<std::shared_ptr<Rhombus<double>>, 4> rhombusArray;
         auto rhombus2 = std::make_shared<Rhombus<double>>(
             Point<double>(0, 2),
             Point<double>(2, 0),
@@ -69,6 +71,19 @@ int main() {
         std::cout << "Enter 4 points for rhombus (x y for each point):" << std::endl;
         std::cin >> inputRhombus;
         std::cout << "You entered: " << inputRhombus << std::endl;
+
+        FigureKind kind = FigureKind::Rhombus;
+        std::vector<double> coords;
+        for (size_t v = 0; v < inputRhombus.vertexCount(); ++v) {
+            coords.push_back(inputRhombus.getVertex(v).getX());
+            coords.push_back(inputRhombus.getVertex(v).getY());
+        }
+        FigureBatchErrors errors = validateFigures(&kind, 1, coords.data(), coords.size());
+        if (errors.has(0, FigureError::UnequalSides)) {
+            std::cout << "Warning: rhombus sides are not equal" << std::endl;
+        } else if (!errors.valid(0)) {
+            std::cout << "Warning: figure is degenerate" << std::endl;
+        }
         
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,127 @@
+#!/usr/bin/env bash
+# Сборка конфигураций (baseline, O3+LTO, -march, PGO) и прогон фаз workload
+# под perf stat. Результаты: perf/results.csv; record сохраняет их как
+# perf/baseline.csv (только при доступном perf stat), compare печатает
+# отношение к сохранённому baseline. baseline.csv зависит от машины и в
+# репозиторий не входит.
+#
+#   scripts/perf_harness.sh [run|record|compare] [figures] [iterations]
+#
+# Переменные окружения:
+#   CONFIGS     конфигурации через пробел (по умолчанию все)
+#   CMAKE_ARGS  дополнительные аргументы cmake
+#   PERF_RECORD=1  дополнительно perf record и доля горячих функций
+set -euo pipefail
+
+mode=${1:-run}
+figures=${2:-1000000}
+iterations=${3:-10}
+root=$(cd "$(dirname "$0")/.." && pwd)
+out="$root/perf"
+builds="$root/_perf_build"
+configs=${CONFIGS:-"baseline o3-lto march-native pgo"}
+phases="area totalArea resize buffer sort"
+events="cycles,instructions,cache-references,cache-misses"
+mkdir -p "$out" "$builds"
+
+have_perf=0
+if command -v perf >/dev/null && perf stat -e cycles true >/dev/null 2>&1; then
+    have_perf=1
+else
+    echo "perf stat unavailable: only wall time is recorded" >&2
+fi
+
+configure() {
+    local name=$1; shift
+    local log="$builds/$name.log"
+    if ! { cmake -S "$root" -B "$builds/$name" ${CMAKE_ARGS:-} "$@" &&
+           cmake --build "$builds/$name" --target workload -j"$(nproc)"; } >"$log" 2>&1; then
+        cat "$log" >&2
+        exit 1
+    fi
+}
+
+build() {
+    local name=$1
+    # Тип сборки задаётся каждой конфигурации: baseline собирается с флагами
+    # репозитория по умолчанию (пустой CMAKE_BUILD_TYPE), остальные — Release
+    local release=-DCMAKE_BUILD_TYPE=Release
+    case $name in
+    baseline)     configure "$name" -DCMAKE_BUILD_TYPE= ;;
+    o3-lto)       configure "$name" $release -DLAB4_OPTIMIZED=ON ;;
+    march-native) configure "$name" $release -DLAB4_OPTIMIZED=ON -DLAB4_MARCH=native ;;
+    pgo)
+        local profile="$builds/$name/pgo-profile"
+        rm -rf "$profile"
+        configure "$name" $release -DLAB4_OPTIMIZED=ON -DLAB4_PGO=GENERATE -DLAB4_PGO_DIR="$profile"
+        "$builds/$name/workload" all "$((figures / 10))" 2 >/dev/null
+        if ls "$profile"/*.profraw >/dev/null 2>&1; then
+            llvm-profdata merge -o "$profile/default.profdata" "$profile"/*.profraw
+        fi
+        configure "$name" $release -DLAB4_OPTIMIZED=ON -DLAB4_PGO=USE -DLAB4_PGO_DIR="$profile"
+        ;;
+    *) echo "unknown configuration: $name" >&2; exit 1 ;;
+    esac
+}
+
+# Строка CSV: config,phase,ms,cycles,instructions,ipc,cache_references,cache_misses
+measure() {
+    local name=$1 phase=$2 binary="$builds/$1/workload"
+    local stat="$builds/$name/$phase.stat" ms
+    if [ "$have_perf" = 1 ]; then
+        ms=$(perf stat -x, -e "$events" -o "$stat" "$binary" "$phase" "$figures" "$iterations" | tail -1 | cut -d, -f2)
+        awk -F, -v c="$name" -v p="$phase" -v ms="$ms" '
+            $3 == "cycles" { cy = $1 } $3 == "instructions" { ins = $1 }
+            $3 == "cache-references" { ref = $1 } $3 == "cache-misses" { miss = $1 }
+            END { printf "%s,%s,%s,%s,%s,%.3f,%s,%s\n", c, p, ms, cy, ins, (cy > 0 ? ins / cy : 0), ref, miss }' "$stat"
+    else
+        ms=$("$binary" "$phase" "$figures" "$iterations" | tail -1 | cut -d, -f2)
+        echo "$name,$phase,$ms,,,,,"
+    fi
+}
+
+hot_functions() {
+    local name=$1 binary="$builds/$1/workload"
+    [ "${PERF_RECORD:-0}" = 1 ] && [ "$have_perf" = 1 ] || return 0
+    perf record -q -o "$builds/$name/perf.data" "$binary" all "$figures" "$iterations" >/dev/null 2>&1
+    echo "== $name: share of samples in hot functions"
+    perf report -i "$builds/$name/perf.data" --stdio --sort symbol 2>/dev/null |
+        grep -E "area|totalArea|Array<.*>::resize" | head -10
+}
+
+# Сохранённый baseline должен содержать счётчики, а не только время
+if [ "$mode" = record ] && [ "$have_perf" = 0 ]; then
+    echo "record needs perf stat counters (cycles, IPC, cache misses); use run instead" >&2
+    exit 1
+fi
+
+if [ "$mode" = compare ]; then
+    [ -f "$out/baseline.csv" ] || { echo "no perf/baseline.csv, run: $0 record" >&2; exit 1; }
+else
+    echo "config,phase,ms,cycles,instructions,ipc,cache_references,cache_misses" > "$out/results.csv"
+    for name in $configs; do
+        build "$name"
+        for phase in $phases; do
+            measure "$name" "$phase" | tee -a "$out/results.csv"
+        done
+        hot_functions "$name"
+    done
+fi
+
+if [ "$mode" = record ]; then
+    {
+        echo "# figures=$figures iterations=$iterations host=$(uname -m) cpus=$(nproc) compiler=$(c++ --version | head -1)"
+        cat "$out/results.csv"
+    } > "$out/baseline.csv"
+    echo "baseline saved to perf/baseline.csv"
+elif [ -f "$out/baseline.csv" ]; then
+    # Время и такты относительно baseline той же конфигурации и фазы (< 1 — быстрее)
+    echo "config,phase,ms_ratio,cycles_ratio"
+    awk -F, '
+        FNR == 1 || /^#/ { next }
+        NR == FNR { ms[$1 "," $2] = $3; cy[$1 "," $2] = $4; next }
+        ($1 "," $2) in ms {
+            k = $1 "," $2
+            printf "%s,%.3f,%s\n", k, $3 / ms[k], (cy[k] > 0 && $4 > 0 ? sprintf("%.3f", $4 / cy[k]) : "")
+        }' "$out/baseline.csv" "$out/results.csv"
+fi
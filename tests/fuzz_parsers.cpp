@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/rhombus.h"
+#include "../include/pentagon.h"
+#include "../include/hexagon.h"
+#include "../include/figure_batch.h"
+#include "../include/figure_codec.h"
+
+// Точка входа для libFuzzer: первый байт выбирает разбор, остальное — вход.
+// Без LAB4_FUZZ собирается как программа, прогоняющая файлы из аргументов
+// (например, сохранённые падения) через ту же функцию.
+
+template<class FigureType>
+static void readText(const std::string& text) {
+    std::istringstream is(text);
+    FigureType figure;
+    is >> figure;
+    (void)figure.area();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) return 0;
+    const uint8_t* input = data + 1;
+    size_t length = size - 1;
+    std::string text(reinterpret_cast<const char*>(input), length);
+
+    switch (data[0] % 5) {
+    case 0:
+        readText<Rhombus<double>>(text);
+        readText<Pentagon<int>>(text);
+        readText<Hexagon<float>>(text);
+        break;
+    case 1: {
+        std::istringstream is(text);
+        std::vector<FigureKind> kinds;
+        std::vector<double> coords;
+        readFigureBatch(is, kinds, coords);
+        FigureBatchErrors errors;
+        auto figures = buildFigures(kinds, coords, errors);
+        if (figures.size() + errors.invalidCount() != kinds.size()) __builtin_trap();
+        break;
+    }
+    case 2: {
+        // Сырые байты как виды и координаты для пакетной проверки
+        size_t figures = length / 2;
+        std::vector<FigureKind> kinds(figures);
+        for (size_t i = 0; i < figures; ++i) kinds[i] = static_cast<FigureKind>(input[i] % 8);
+        std::vector<float> coords(input + figures, input + length);
+        validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size());
+        break;
+    }
+    default:
+        try {
+            if (data[0] % 5 == 3) {
+                FigureBuffer<double> buffer = decodeFigures<double>(input, length);
+                std::vector<uint8_t> again = encodeFigures(buffer);
+                if (decodeFigures<double>(again).coordCount() != buffer.coordCount()) __builtin_trap();
+            } else {
+                decodeFigures<int>(input, length).totalArea();
+            }
+        } catch (const std::exception&) {
+        }
+        break;
+    }
+    return 0;
+}
+
+#ifndef LAB4_FUZZ
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+        std::printf("%s: ok\n", argv[i]);
+    }
+    return 0;
+}
+#endif
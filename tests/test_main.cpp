@@ -1,12 +1,35 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <thread>
 #include "../include/point.h"
 #include "../include/figure.h"
 #include "../include/rhombus.h"
 #include "../include/pentagon.h"
 #include "../include/hexagon.h"
 #include "../include/array.h"
+#include "../include/array_sort.h"
+#include "../include/small_array.h"
+#include "../include/figure_bounds.h"
+#include "../include/cow_array.h"
+#include "../include/array_of_figures.h"
+#include "../include/figure_buffer.h"
+#include "../include/memory_footprint.h"
+#include "../include/static_figure.h"
+#include "../include/figure_aggregator.h"
+#include "../include/figure_codec.h"
+#include "../include/robust_predicates.h"
+#include "../include/shared_figures.h"
+#include "../include/numa.h"
+#include "../include/figure_batch.h"
+#include "../include/figure_workload.h"
+#include "../include/figure_raster.h"
+#include "../include/figure_pool.h"
+#include "../include/figure_join.h"
 
 // Тесты для Point
 TEST(PointTest, DefaultConstructor) {
@@ -465,6 +488,1351 @@ TEST(IntegrationTest, FigurePolymorphism) {
     EXPECT_NEAR(center3.getY(), 0.0, 1e-6);
 }
 
+// Тесты сортировки массива фигур
+static Array<std::shared_ptr<Figure<double>>> makeHexagonsWithRadii(const std::vector<double>& radii) {
+    Array<std::shared_ptr<Figure<double>>> figures;
+    for (size_t i = 0; i < radii.size(); ++i) {
+        figures.push_back(std::make_shared<Hexagon<double>>(Point<double>(radii.size() - i, 0), radii[i]));
+    }
+    return figures;
+}
+
+TEST(ArraySortTest, SortByArea) {
+    auto figures = makeHexagonsWithRadii({3.0, 1.0, 4.0, 1.5, 2.0});
+    sortByArea(figures);
+
+    ASSERT_EQ(figures.size(), 5);
+    for (size_t i = 1; i < figures.size(); ++i) {
+        EXPECT_LE(figures[i - 1]->area(), figures[i]->area());
+    }
+}
+
+TEST(ArraySortTest, SortByAreaLarge) {
+    std::vector<double> radii;
+    for (int i = 0; i < 200000; ++i) {
+        radii.push_back(1.0 + (i * 7919) % 1000);
+    }
+    auto figures = makeHexagonsWithRadii(radii);
+    sortByArea(figures, true);
+
+    ASSERT_EQ(figures.size(), radii.size());
+    for (size_t i = 1; i < figures.size(); ++i) {
+        ASSERT_GE(figures[i - 1]->area(), figures[i]->area());
+    }
+}
+
+TEST(ArraySortTest, SortByCenterX) {
+    auto figures = makeHexagonsWithRadii({1.0, 2.0, 3.0});
+    sortByCenterX(figures);
+
+    EXPECT_NEAR(figures[0]->geometricCenter().getX(), 1.0, 1e-6);
+    EXPECT_NEAR(figures[1]->geometricCenter().getX(), 2.0, 1e-6);
+    EXPECT_NEAR(figures[2]->geometricCenter().getX(), 3.0, 1e-6);
+}
+
+TEST(ArraySortTest, PartialSortByArea) {
+    auto figures = makeHexagonsWithRadii({3.0, 1.0, 4.0, 1.5, 2.0});
+    auto largest = figures[2];
+    auto second = figures[0];
+    partialSortByArea(figures, 2, true);
+
+    ASSERT_EQ(figures.size(), 5);
+    EXPECT_EQ(figures[0], largest);
+    EXPECT_EQ(figures[1], second);
+}
+
+TEST(ArraySortTest, TopKByArea) {
+    auto figures = makeHexagonsWithRadii({3.0, 1.0, 4.0, 1.5, 2.0});
+    auto top = topKByArea(figures, 3);
+
+    ASSERT_EQ(top.size(), 3);
+    EXPECT_EQ(top[0], figures[2]);
+    EXPECT_EQ(top[1], figures[0]);
+    EXPECT_EQ(top[2], figures[4]);
+    EXPECT_EQ(topKByArea(figures, 10).size(), 5);
+}
+
+// Тесты для SmallArray
+TEST(SmallArrayTest, InlineUntilCapacity) {
+    SmallArray<int, 4> array;
+    EXPECT_EQ(array.capacity(), 4);
+    for (int i = 0; i < 4; ++i) {
+        array.push_back(i);
+    }
+    EXPECT_TRUE(array.is_inline());
+    EXPECT_EQ(array.size(), 4);
+}
+
+TEST(SmallArrayTest, SpillsToHeap) {
+    SmallArray<int, 2> array;
+    for (int i = 0; i < 10; ++i) {
+        array.push_back(i);
+    }
+    EXPECT_FALSE(array.is_inline());
+    EXPECT_EQ(array.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(array[i], i);
+    }
+}
+
+TEST(SmallArrayTest, EraseAndOutOfRange) {
+    SmallArray<int, 4> array;
+    array.push_back(1);
+    array.push_back(2);
+    array.push_back(3);
+
+    array.erase(1);
+    EXPECT_EQ(array.size(), 2);
+    EXPECT_EQ(array[1], 3);
+    EXPECT_THROW(array[2], std::out_of_range);
+    EXPECT_THROW(array.erase(5), std::out_of_range);
+}
+
+TEST(SmallArrayTest, CopyInlineAndHeap) {
+    SmallArray<int, 2> small;
+    small.push_back(1);
+    SmallArray<int, 2> big;
+    for (int i = 0; i < 5; ++i) {
+        big.push_back(i);
+    }
+
+    SmallArray<int, 2> smallCopy(small);
+    SmallArray<int, 2> bigCopy;
+    bigCopy = big;
+
+    EXPECT_TRUE(smallCopy.is_inline());
+    EXPECT_EQ(smallCopy[0], 1);
+    EXPECT_EQ(bigCopy.size(), 5);
+    EXPECT_EQ(bigCopy[4], 4);
+    EXPECT_EQ(big[4], 4);
+}
+
+TEST(SmallArrayTest, MoveInlineAndHeap) {
+    SmallArray<std::shared_ptr<Figure<double>>, 2> small;
+    auto rhombus = std::make_shared<Rhombus<double>>();
+    small.push_back(rhombus);
+
+    SmallArray<std::shared_ptr<Figure<double>>, 2> moved(std::move(small));
+    EXPECT_EQ(small.size(), 0);
+    EXPECT_EQ(moved[0], rhombus);
+    EXPECT_EQ(rhombus.use_count(), 2);
+
+    SmallArray<int, 2> big;
+    for (int i = 0; i < 5; ++i) {
+        big.push_back(i);
+    }
+    SmallArray<int, 2> target;
+    target = std::move(big);
+    EXPECT_EQ(big.size(), 0);
+    EXPECT_EQ(target.size(), 5);
+    EXPECT_FALSE(target.is_inline());
+}
+
+TEST(SmallArrayTest, ReleasesDroppedElements) {
+    auto sp = std::make_shared<int>(7);
+    SmallArray<std::shared_ptr<int>, 4> array;
+    array.push_back(sp);
+    array.push_back(sp);
+    array = SmallArray<std::shared_ptr<int>, 4>();
+    EXPECT_EQ(sp.use_count(), 1);
+
+    // Переход в кучу, удаление и очистка тоже не оставляют копий
+    for (int i = 0; i < 6; ++i) {
+        array.push_back(sp);
+    }
+    EXPECT_FALSE(array.is_inline());
+    EXPECT_EQ(sp.use_count(), 7);
+    array.erase(0);
+    EXPECT_EQ(sp.use_count(), 6);
+    array.clear();
+    EXPECT_EQ(sp.use_count(), 1);
+
+    SmallArray<std::shared_ptr<int>, 4> source;
+    source.push_back(sp);
+    array.push_back(sp);
+    array.push_back(sp);
+    array = std::move(source);
+    EXPECT_EQ(array.size(), 1);
+    EXPECT_EQ(sp.use_count(), 2);
+}
+
+// Тесты ограничивающих объёмов коллекции
+static Array<std::shared_ptr<Figure<double>>> makeBoundsFigures() {
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.push_back(std::make_shared<Rhombus<double>>(
+        Point<double>(0, 1), Point<double>(1, 0), Point<double>(0, -1), Point<double>(-1, 0)));
+    figures.push_back(std::make_shared<Hexagon<double>>(Point<double>(10, 0), 1.0));
+    figures.push_back(std::make_shared<Pentagon<double>>(Point<double>(5, 0), 0.5));
+    return figures;
+}
+
+TEST(FigureBoundsTest, VertexAccessThroughBase) {
+    auto figures = makeBoundsFigures();
+    EXPECT_EQ(figures[0]->vertexCount(), 4);
+    EXPECT_EQ(figures[1]->vertexCount(), 6);
+    EXPECT_EQ(figures[2]->vertexCount(), 5);
+    EXPECT_TRUE(figures[0]->getVertex(1) == Point<double>(1, 0));
+    EXPECT_EQ(collectVertices(figures).size(), 15);
+}
+
+TEST(FigureBoundsTest, BoundingBox) {
+    auto figures = makeBoundsFigures();
+    auto box = boundingBox(figures);
+    EXPECT_NEAR(box.minX, -1.0, 1e-9);
+    EXPECT_NEAR(box.maxX, 11.0, 1e-9);
+    EXPECT_NEAR(box.minY, -1.0, 1e-9);
+    EXPECT_NEAR(box.maxY, 1.0, 1e-9);
+    EXPECT_TRUE(boundingBox(Array<std::shared_ptr<Figure<double>>>()).empty());
+}
+
+TEST(FigureBoundsTest, ConvexHull) {
+    auto figures = makeBoundsFigures();
+    auto hull = convexHull(figures);
+    auto vertices = collectVertices(figures);
+
+    ASSERT_GE(hull.size(), 3u);
+    for (size_t i = 0; i < hull.size(); ++i) {
+        const auto& a = hull[i];
+        const auto& b = hull[(i + 1) % hull.size()];
+        for (const auto& p : vertices) {
+            EXPECT_GE(cross(a, b, p), -1e-9);
+        }
+    }
+}
+
+TEST(FigureBoundsTest, ParallelHullMatchesSequential) {
+    std::vector<Point<double>> points;
+    for (int i = 0; i < 300000; ++i) {
+        double angle = i * 0.001;
+        double r = 1.0 + (i % 97) / 100.0;
+        points.emplace_back(r * std::cos(angle), r * std::sin(angle));
+    }
+    auto sorted = points;
+    std::sort(sorted.begin(), sorted.end(), lexicographicLess<double>);
+    auto expected = monotoneChain(sorted);
+    auto hull = convexHull(points);
+
+    ASSERT_EQ(hull.size(), expected.size());
+    for (size_t i = 0; i < hull.size(); ++i) {
+        EXPECT_TRUE(hull[i] == expected[i]);
+    }
+}
+
+TEST(FigureBoundsTest, MinimumEnclosingCircle) {
+    auto figures = makeBoundsFigures();
+    Circle circle = minimumEnclosingCircle(figures);
+    EXPECT_NEAR(circle.center.getX(), 5.0, 1e-6);
+    EXPECT_NEAR(circle.center.getY(), 0.0, 1e-6);
+    EXPECT_NEAR(circle.radius, 6.0, 1e-6);
+    for (const auto& p : collectVertices(figures)) {
+        EXPECT_TRUE(circle.contains(p));
+    }
+}
+
+// Тесты для CowArray
+TEST(CowArrayTest, PushBackAcrossChunks) {
+    CowArray<int, 4> array;
+    for (int i = 0; i < 10; ++i) {
+        array.push_back(i);
+    }
+    EXPECT_EQ(array.size(), 10);
+    EXPECT_EQ(array.chunkCount(), 3);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(array[i], i);
+    }
+    EXPECT_THROW(array[10], std::out_of_range);
+}
+
+TEST(CowArrayTest, SnapshotIsIsolatedFromWrites) {
+    CowArray<int, 4> array;
+    for (int i = 0; i < 12; ++i) {
+        array.push_back(i);
+    }
+    CowArray<int, 4> snapshot = array.snapshot();
+    EXPECT_EQ(snapshot.sharedChunks(array), 3);
+
+    array.set(5, 100);
+    array.push_back(12);
+
+    EXPECT_EQ(array[5], 100);
+    EXPECT_EQ(snapshot[5], 5);
+    EXPECT_EQ(snapshot.size(), 12);
+    EXPECT_EQ(array.size(), 13);
+    EXPECT_EQ(snapshot.sharedChunks(array), 2);
+}
+
+TEST(CowArrayTest, EraseAndPopBack) {
+    CowArray<int, 2> array;
+    for (int i = 0; i < 5; ++i) {
+        array.push_back(i);
+    }
+    auto snapshot = array.snapshot();
+
+    array.erase(1);
+    EXPECT_EQ(array.size(), 4);
+    EXPECT_EQ(array[1], 2);
+    EXPECT_EQ(array[3], 4);
+    EXPECT_EQ(array.chunkCount(), 2);
+    EXPECT_EQ(snapshot[1], 1);
+    EXPECT_EQ(snapshot.size(), 5);
+
+    array.clear();
+    EXPECT_TRUE(array.empty());
+    EXPECT_THROW(array.pop_back(), std::out_of_range);
+}
+
+TEST(CowArrayTest, ReferenceTakenBeforeSnapshotDoesNotWriteIntoIt) {
+    static_assert(std::is_const<std::remove_reference_t<decltype(std::declval<CowArray<int, 4>&>()[0])>>::value,
+                  "CowArray elements change only through set()");
+    CowArray<int, 4> array;
+    for (int i = 0; i < 6; ++i) {
+        array.push_back(i);
+    }
+    const int& ref = array[0];
+    auto snapshot = array.snapshot();
+    array.set(0, 42);
+
+    EXPECT_EQ(array[0], 42);
+    EXPECT_EQ(snapshot[0], 0);
+    EXPECT_EQ(ref, 0);
+    EXPECT_THROW(array.set(6, 1), std::out_of_range);
+}
+
+TEST(CowArrayTest, FromArrayAndTotalArea) {
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.push_back(std::make_shared<Rhombus<double>>(
+        Point<double>(0, 1), Point<double>(1, 0), Point<double>(0, -1), Point<double>(-1, 0)));
+    figures.push_back(std::make_shared<Hexagon<double>>(Point<double>(0, 0), 1.0));
+
+    CowArray<std::shared_ptr<Figure<double>>> cow(figures);
+    EXPECT_EQ(cow.size(), 2);
+    EXPECT_NEAR(totalArea(cow), totalArea(figures), 1e-9);
+    EXPECT_EQ(cow.toArray()[1], figures[1]);
+}
+
+// Тесты учёта памяти и плотного хранения
+TEST(FigureBufferTest, MatchesFigures) {
+    auto figures = makeBoundsFigures();
+    for (int i = 0; i < 200; ++i) {
+        figures.push_back(std::make_shared<Pentagon<double>>(Point<double>(i, -i), 1.0 + i % 7));
+    }
+    FigureBuffer<double> buffer(figures);
+
+    ASSERT_EQ(buffer.size(), figures.size());
+    EXPECT_EQ(buffer.kind(0), FigureKind::Rhombus);
+    EXPECT_EQ(buffer.kind(1), FigureKind::Hexagon);
+    for (size_t i = 0; i < figures.size(); ++i) {
+        EXPECT_DOUBLE_EQ(buffer.area(i), figures[i]->area());
+        EXPECT_TRUE(buffer.geometricCenter(i) == figures[i]->geometricCenter());
+        EXPECT_TRUE(*buffer.figure(i) == *figures[i]);
+    }
+    EXPECT_NEAR(buffer.totalArea(), totalArea(figures), 1e-9);
+    EXPECT_EQ(buffer.toArray().size(), figures.size());
+    EXPECT_THROW(buffer.kind(figures.size()), std::out_of_range);
+}
+
+TEST(MemoryFootprintTest, FigureBreakdown) {
+    Hexagon<double> hexagon(Point<double>(0, 0), 1.0);
+    MemoryFootprint m = figureFootprint(hexagon);
+
+    EXPECT_EQ(m.figures, 1);
+    EXPECT_EQ(m.figureObjects, sizeof(Hexagon<double>));
+    EXPECT_EQ(m.vertexHeap, 6 * sizeof(Point<double>));
+    EXPECT_EQ(m.vtablePointers, sizeof(void*));
+    EXPECT_GT(m.allocatorOverhead, 0u);
+}
+
+TEST(MemoryFootprintTest, CollectionIncludesSlack) {
+    Array<std::shared_ptr<Figure<double>>> figures;
+    for (int i = 0; i < 5; ++i) {
+        figures.push_back(std::make_shared<Rhombus<double>>());
+    }
+    MemoryFootprint m = memoryFootprint(figures);
+
+    EXPECT_EQ(m.figures, 5);
+    EXPECT_EQ(m.arrayBuffer, 5 * sizeof(std::shared_ptr<Figure<double>>));
+    EXPECT_EQ(m.arraySlack, 3 * sizeof(std::shared_ptr<Figure<double>>));
+
+    figures.shrink_to_fit();
+    EXPECT_EQ(figures.capacity(), 5);
+    EXPECT_EQ(memoryFootprint(figures).arraySlack, 0);
+}
+
+TEST(MemoryFootprintTest, CompactSavesMemory) {
+    auto figures = makeBoundsFigures();
+    CompactReport report;
+    FigureBuffer<double> buffer = compact(figures, &report);
+
+    EXPECT_EQ(buffer.size(), figures.size());
+    EXPECT_LT(report.bytesAfter, report.bytesBefore);
+    EXPECT_EQ(report.saved(), report.bytesBefore - report.bytesAfter);
+}
+
+// Тесты вычислений на этапе компиляции
+static_assert(Point<int>(1, 2) == Point<int>(1, 2), "constexpr Point comparison");
+static_assert(Point<double>(1.0, 2.0).getY() == 2.0, "constexpr Point access");
+static_assert(constexprSqrt(16.0) == 4.0, "constexpr sqrt");
+static_assert(unitStamp(FigureKind::Hexagon).area > 2.598 && unitStamp(FigureKind::Hexagon).area < 2.599,
+              "hexagon area table computed at compile time");
+
+TEST(ConstexprMathTest, MatchesCmath) {
+    for (double v : {1e-300, 0.3, 2.0, 3.0, 5.0, 12345.678, 1e300}) {
+        EXPECT_NEAR(constexprSqrt(v), std::sqrt(v), std::sqrt(v) * 1e-15);
+    }
+    EXPECT_TRUE(std::isnan(constexprSqrt(-1.0)));
+    for (double a = -20.0; a <= 20.0; a += 0.37) {
+        EXPECT_NEAR(constexprSin(a), std::sin(a), 1e-13);
+        EXPECT_NEAR(constexprCos(a), std::cos(a), 1e-13);
+    }
+}
+
+TEST(StaticFigureTest, MatchesRuntimeFigures) {
+    constexpr auto pentagon = StaticPentagon<double>::regular(Point<double>(2, 3), 1.0);
+    constexpr auto hexagon = unitHexagon.translated(1, 2);
+    constexpr double pentagonArea = pentagon.area();
+
+    Pentagon<double> runtimePentagon(Point<double>(2, 3), 1.0);
+    Hexagon<double> runtimeHexagon(Point<double>(0, 0), 1.0);
+    EXPECT_NEAR(pentagonArea, runtimePentagon.area(), 1e-12);
+    EXPECT_NEAR(hexagon.area(), runtimeHexagon.area(), 1e-12);
+    EXPECT_TRUE(*pentagon.toFigure() == runtimePentagon);
+    EXPECT_NEAR(hexagon.geometricCenter().getX(), 1.0, 1e-12);
+    EXPECT_NEAR(hexagon.geometricCenter().getY(), 2.0, 1e-12);
+}
+
+TEST(StaticFigureTest, StampTable) {
+    EXPECT_NEAR(unitStamp(FigureKind::Rhombus).area, 2.0, 1e-12);
+    EXPECT_NEAR(unitStamp(FigureKind::Pentagon).area, Pentagon<double>(Point<double>(0, 0), 1.0).area(), 1e-12);
+    EXPECT_NEAR(unitStamp(FigureKind::Hexagon).centerX, 0.0, 1e-12);
+    EXPECT_NEAR(scaledArea(unitHexagon, 2.0), Hexagon<double>(Point<double>(0, 0), 2.0).area(), 1e-9);
+}
+
+// Тесты потоковой агрегации
+TEST(FigureAggregatorTest, InsertEraseUpdate) {
+    FigureAggregator aggregator;
+    Rhombus<double> rhombus(Point<double>(0, 1), Point<double>(1, 0), Point<double>(0, -1), Point<double>(-1, 0));
+    Hexagon<double> hexagon(Point<double>(10, 0), 1.0);
+    Hexagon<double> bigHexagon(Point<double>(10, 0), 2.0);
+
+    aggregator.insert(1, rhombus);
+    aggregator.insert(2, hexagon);
+    EXPECT_EQ(aggregator.size(), 2);
+    EXPECT_EQ(aggregator.count(FigureKind::Hexagon), 1);
+    EXPECT_NEAR(aggregator.totalArea(), rhombus.area() + hexagon.area(), 1e-12);
+    EXPECT_NEAR(aggregator.centroid().getX(), 5.0, 1e-12);
+    EXPECT_NEAR(aggregator.boundingBox().maxX, 11.0, 1e-12);
+    EXPECT_THROW(aggregator.insert(1, hexagon), std::invalid_argument);
+
+    aggregator.update(2, bigHexagon);
+    EXPECT_NEAR(aggregator.totalArea(), rhombus.area() + bigHexagon.area(), 1e-12);
+    EXPECT_NEAR(aggregator.boundingBox().maxX, 12.0, 1e-12);
+
+    aggregator.erase(2);
+    EXPECT_EQ(aggregator.count(FigureKind::Hexagon), 0);
+    EXPECT_NEAR(aggregator.boundingBox().maxX, 1.0, 1e-12);
+    EXPECT_NEAR(aggregator.totalArea(), rhombus.area(), 1e-12);
+    EXPECT_THROW(aggregator.erase(2), std::out_of_range);
+}
+
+TEST(FigureAggregatorTest, RejectsNonFiniteFigures) {
+    FigureAggregator aggregator;
+    Hexagon<double> hexagon(Point<double>(0, 0), 1.0);
+    Hexagon<double> broken(Point<double>(std::nan(""), 0), 1.0);
+    Hexagon<double> infinite(Point<double>(0, 0), std::numeric_limits<double>::infinity());
+
+    aggregator.insert(1, hexagon);
+    EXPECT_THROW(aggregator.insert(2, broken), std::invalid_argument);
+    EXPECT_THROW(aggregator.insert(3, infinite), std::invalid_argument);
+    EXPECT_THROW(aggregator.update(1, broken), std::invalid_argument);
+    EXPECT_FALSE(aggregator.contains(2));
+    EXPECT_EQ(aggregator.size(), 1);
+    EXPECT_NEAR(aggregator.totalArea(), hexagon.area(), 1e-12);
+
+    aggregator.erase(1);
+    EXPECT_TRUE(aggregator.empty());
+
+    SlidingWindowAggregator window(5);
+    EXPECT_THROW(window.add(0, broken), std::invalid_argument);
+    window.add(1, hexagon);
+    window.advance(10);
+    EXPECT_TRUE(window.current().empty());
+}
+
+TEST(FigureAggregatorTest, ReconcileAfterManyEvents) {
+    FigureAggregator aggregator;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        aggregator.insert(i, Hexagon<double>(Point<double>(i * 0.1, 0), 1e-3 + (i % 13) * 1e3));
+    }
+    for (uint64_t i = 0; i < 10000; i += 2) {
+        aggregator.erase(i);
+    }
+    double incremental = aggregator.totalArea();
+    ReconcileReport report = aggregator.reconcile();
+
+    EXPECT_LT(report.areaDrift, std::abs(incremental) * 1e-12);
+    EXPECT_NEAR(aggregator.totalArea(), incremental, std::abs(incremental) * 1e-12);
+}
+
+TEST(FigureAggregatorTest, SlidingWindow) {
+    EXPECT_THROW(SlidingWindowAggregator(0), std::invalid_argument);
+    SlidingWindowAggregator window(10);
+    Hexagon<double> hexagon(Point<double>(0, 0), 1.0);
+
+    window.add(0, hexagon);
+    window.add(5, hexagon);
+    EXPECT_EQ(window.current().size(), 2);
+    window.add(12, hexagon);
+    EXPECT_EQ(window.current().size(), 2);
+    window.advance(100);
+    EXPECT_TRUE(window.current().empty());
+}
+
+TEST(FigureAggregatorTest, TumblingWindow) {
+    TumblingWindowAggregator window(10);
+    Pentagon<double> pentagon(Point<double>(0, 0), 1.0);
+
+    EXPECT_FALSE(window.add(1, pentagon).has_value());
+    EXPECT_FALSE(window.add(9, pentagon).has_value());
+    auto closed = window.add(10, pentagon);
+    ASSERT_TRUE(closed.has_value());
+    EXPECT_EQ(closed->count, 2);
+    EXPECT_EQ(closed->countOf(FigureKind::Pentagon), 2);
+    EXPECT_NEAR(closed->totalArea, 2 * pentagon.area(), 1e-12);
+    EXPECT_EQ(window.current().size(), 1);
+    EXPECT_EQ(window.currentWindowStart(), 10);
+}
+
+TEST(FigureAggregatorTest, TumblingWindowKeepsStateOnRejectedFigure) {
+    TumblingWindowAggregator window(10);
+    Pentagon<double> pentagon(Point<double>(0, 0), 1.0);
+    Pentagon<double> broken(Point<double>(std::nan(""), 0), 1.0);
+
+    window.add(1, pentagon);
+    window.add(2, pentagon);
+    EXPECT_THROW(window.add(15, broken), std::invalid_argument);
+    EXPECT_EQ(window.currentWindowStart(), 0);
+    EXPECT_EQ(window.current().size(), 2);
+
+    auto closed = window.add(15, pentagon);
+    ASSERT_TRUE(closed.has_value());
+    EXPECT_EQ(closed->count, 2);
+    EXPECT_EQ(window.current().size(), 1);
+}
+
+// Тесты сжатого колоночного формата
+static FigureBuffer<double> makeCodecBuffer() {
+    FigureBuffer<double> buffer;
+    for (int i = 0; i < 300; ++i) {
+        double c = i * 0.37 - 50;
+        Pentagon<double> pentagon(Point<double>(c, -c), 1.0 + i % 5);
+        Hexagon<double> hexagon(Point<double>(-c, c * 2), 0.25 * (i % 9 + 1));
+        Rhombus<double> rhombus(Point<double>(c, 1), Point<double>(c + 1, 0),
+                                Point<double>(c, -1), Point<double>(c - 1, 0));
+        buffer.push_back(pentagon);
+        buffer.push_back(hexagon);
+        buffer.push_back(rhombus);
+    }
+    return buffer;
+}
+
+TEST(FigureCodecTest, LosslessRoundTrip) {
+    FigureBuffer<double> buffer = makeCodecBuffer();
+    std::vector<uint8_t> encoded = encodeFigures(buffer);
+    FigureBuffer<double> decoded = decodeFigures<double>(encoded);
+
+    ASSERT_EQ(decoded.size(), buffer.size());
+    ASSERT_EQ(decoded.coordCount(), buffer.coordCount());
+    EXPECT_EQ(std::memcmp(decoded.coordData(), buffer.coordData(), buffer.coordCount() * sizeof(double)), 0);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        EXPECT_EQ(decoded.kind(i), buffer.kind(i));
+    }
+    EXPECT_LT(encoded.size(), buffer.coordCount() * sizeof(double) / 2);
+}
+
+TEST(FigureCodecTest, ToleranceModeStoresRotatedShapes) {
+    FigureBuffer<double> buffer;
+    const double angle = 0.3;
+    double xy[12];
+    for (int i = 0; i < 6; ++i) {
+        xy[2 * i] = 5 + 2 * std::cos(angle + 2 * M_PI * i / 6);
+        xy[2 * i + 1] = -1 + 2 * std::sin(angle + 2 * M_PI * i / 6);
+    }
+    buffer.push_back(FigureKind::Hexagon, xy);
+
+    std::vector<uint8_t> lossless = encodeFigures(buffer);
+    std::vector<uint8_t> lossy = encodeFigures(buffer, 1e-9);
+    FigureBuffer<double> decoded = decodeFigures<double>(lossy);
+
+    EXPECT_LT(lossy.size(), lossless.size());
+    for (size_t i = 0; i < 12; ++i) {
+        EXPECT_NEAR(decoded.coordData()[i], xy[i], 1e-9);
+    }
+}
+
+TEST(FigureCodecTest, IntegerCoordinates) {
+    FigureBuffer<int> buffer;
+    int xy[8] = {0, 2, 2, 0, 0, -2, -2, 0};
+    for (int i = 0; i < 100; ++i) {
+        xy[0] += i;
+        buffer.push_back(FigureKind::Rhombus, xy);
+    }
+    FigureBuffer<int> decoded = decodeFigures<int>(encodeFigures(buffer));
+
+    ASSERT_EQ(decoded.coordCount(), buffer.coordCount());
+    for (size_t i = 0; i < buffer.coordCount(); ++i) {
+        EXPECT_EQ(decoded.coordData()[i], buffer.coordData()[i]);
+    }
+}
+
+TEST(FigureCodecTest, RejectsCorruptedInput) {
+    std::vector<uint8_t> encoded = encodeFigures(makeCodecBuffer());
+    EXPECT_THROW(decodeFigures<float>(encoded), std::runtime_error);
+
+    std::vector<uint8_t> truncated(encoded.begin(), encoded.begin() + encoded.size() / 2);
+    EXPECT_THROW(decodeFigures<double>(truncated), std::runtime_error);
+
+    std::vector<uint8_t> badCount = encoded;
+    badCount[5] ^= 0x40;
+    EXPECT_THROW(decodeFigures<double>(badCount), std::runtime_error);
+}
+
+// Тесты устойчивых предикатов
+TEST(RobustPredicatesTest, OrientationSimple) {
+    EXPECT_EQ(orient2d(Point<double>(0, 0), Point<double>(1, 0), Point<double>(0, 1)), 1);
+    EXPECT_EQ(orient2d(Point<double>(0, 0), Point<double>(0, 1), Point<double>(1, 0)), -1);
+    EXPECT_EQ(orient2d(Point<double>(0, 0), Point<double>(1, 1), Point<double>(2, 2)), 0);
+    EXPECT_EQ(orient2d(Point<int>(0, 0), Point<int>(3, 0), Point<int>(1, 1)), 1);
+}
+
+TEST(RobustPredicatesTest, OrientationNearDegenerate) {
+    // Точки почти на прямой y = x: наивная формула ошибается в знаке, точная — нет
+    Point<double> a(0.5, 0.5), b(12, 12), c(24, 24);
+    int mismatches = 0;
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < 64; ++j) {
+            Point<double> p(0.5 + i * std::ldexp(1.0, -53), 0.5 + j * std::ldexp(1.0, -53));
+            int exact = orient2dExact(p, b, c);
+            EXPECT_EQ(orient2d(p, b, c), exact);
+            double fast = orient2dFast(p, b, c);
+            int naive = fast > 0 ? 1 : (fast < 0 ? -1 : 0);
+            if (naive != exact) ++mismatches;
+        }
+    }
+    EXPECT_GT(mismatches, 0);
+    EXPECT_FALSE(orient2dFilterDecides(a, b, c));
+}
+
+TEST(RobustPredicatesTest, AreaAndOrientationOfFigures) {
+    Rhombus<double> rhombus(Point<double>(0, 1), Point<double>(1, 0), Point<double>(0, -1), Point<double>(-1, 0));
+    Hexagon<double> hexagon(Point<double>(1e9, 1e9), 1.0);
+    EXPECT_NEAR(robustArea(rhombus), 2.0, 1e-12);
+    EXPECT_EQ(robustOrientation(rhombus), -1);
+    EXPECT_EQ(robustOrientation(hexagon), 1);
+    EXPECT_NEAR(robustArea(hexagon), hexagon.area(), 1e-6);
+    EXPECT_TRUE(isStrictlyConvex(hexagon));
+
+    Rhombus<double> flat(Point<double>(0, 0), Point<double>(1, 1), Point<double>(2, 2), Point<double>(3, 3));
+    EXPECT_EQ(robustOrientation(flat), 0);
+    EXPECT_FALSE(isStrictlyConvex(flat));
+}
+
+TEST(RobustPredicatesTest, StarPolygonIsNotConvex) {
+    // Вершины правильного пятиугольника через одну: все повороты в одну сторону, но два оборота
+    Pentagon<double> pentagon(Point<double>(0, 0), 1.0);
+    Point<double> star[5];
+    for (size_t i = 0; i < 5; ++i) {
+        star[i] = pentagon.getVertex(2 * i % 5);
+    }
+    EXPECT_TRUE(isStrictlyConvex(pentagon));
+    EXPECT_FALSE(isStrictlyConvex(star, 5));
+
+    Pentagon<double> starFigure(star[0], star[1], star[2], star[3], star[4]);
+    EXPECT_FALSE(isStrictlyConvex(starFigure));
+}
+
+TEST(RobustPredicatesTest, IntegerFiguresAreNotTruncated) {
+    Pentagon<int> pentagon(Point<int>(0, 0), Point<int>(1, 1), Point<int>(0, 2), Point<int>(-1, 2), Point<int>(-1, 1));
+    EXPECT_NEAR(pentagon.area(), 2 * 1.7204774005889669, 1e-9);
+
+    Rhombus<int> rhombus(Point<int>(0, 1), Point<int>(1, 0), Point<int>(0, -1), Point<int>(-2, 0));
+    Point<double> center = robustCenter(rhombus);
+    EXPECT_DOUBLE_EQ(center.getX(), -0.25);
+    EXPECT_EQ(rhombus.geometricCenter().getX(), 0);
+}
+
+TEST(RobustPredicatesTest, UlpEquality) {
+    double big = 1e12;
+    Point<double> a(big, big);
+    Point<double> b(std::nextafter(big, 2e12), big);
+    EXPECT_FALSE(a == Point<double>(big + 1e-3, big));
+    EXPECT_TRUE(ulpEquals(a, b, 1));
+    EXPECT_FALSE(ulpEquals(a, Point<double>(big + 1e-3, big), 4));
+    EXPECT_EQ(ulpDistance(-0.0, 0.0), 0);
+    EXPECT_EQ(ulpDistance(1.0, std::nextafter(1.0, 2.0)), 1);
+
+    Hexagon<double> h1(Point<double>(0, 0), 1.0);
+    Hexagon<double> h2(h1);
+    Pentagon<double> p(Point<double>(0, 0), 1.0);
+    EXPECT_TRUE(robustEquals(h1, h2, 0));
+    EXPECT_FALSE(robustEquals<double>(h1, p));
+}
+
+TEST(RobustPredicatesTest, FloatUlpEquality) {
+    float one = 1.0f, next = std::nextafter(one, 2.0f);
+    EXPECT_EQ(ulpDistance(one, next), 1u);
+    EXPECT_EQ(ulpDistance(-0.0f, 0.0f), 0u);
+    EXPECT_EQ(ulpDistance(-next, next), 2 * ulpDistance(0.0f, next));
+    EXPECT_TRUE(ulpEquals(Point<float>(one, 2.0f), Point<float>(next, 2.0f), 1));
+    EXPECT_FALSE(ulpEquals(Point<float>(one, 2.0f), Point<float>(next, 2.0f), 0));
+
+    // Фигуры, отличающиеся одним шагом округления float, равны при допуске 4 ulp
+    Rhombus<float> a(Point<float>(0, 1), Point<float>(1, 0), Point<float>(0, -1), Point<float>(-1, 0));
+    Rhombus<float> b(Point<float>(0, next), Point<float>(1, 0), Point<float>(0, -1), Point<float>(-1, 0));
+    EXPECT_TRUE(robustEquals(a, b));
+    EXPECT_FALSE(robustEquals(a, b, 0));
+}
+
+// Тесты обработки в нескольких процессах через shared memory
+#if defined(__unix__) || defined(__APPLE__)
+TEST(SharedFiguresTest, ShardedAggregateMatchesSingleProcess) {
+    FigureBuffer<double> buffer = makeCodecBuffer();
+    std::string name = "/lab4_test_" + std::to_string(getpid());
+    auto region = SharedFigureRegion<double>::create(name, buffer, 8);
+
+    ASSERT_EQ(region.size(), buffer.size());
+    ShardedAggregate aggregate = shardedAggregate(region, 4);
+
+    EXPECT_EQ(aggregate.count, buffer.size());
+    EXPECT_EQ(aggregate.countOf(FigureKind::Rhombus), 300);
+    EXPECT_NEAR(aggregate.totalArea, buffer.totalArea(), 1e-9 * buffer.totalArea());
+
+    auto figures = buffer.toArray();
+    auto box = boundingBox(figures);
+    EXPECT_DOUBLE_EQ(aggregate.box.minX, box.minX);
+    EXPECT_DOUBLE_EQ(aggregate.box.maxY, box.maxY);
+}
+
+TEST(SharedFiguresTest, IntegerCentersAreNotTruncated) {
+    FigureBuffer<int> buffer;
+    buffer.push_back(Rhombus<int>(Point<int>(0, 1), Point<int>(1, 0), Point<int>(0, -1), Point<int>(-2, 0)));
+    std::string name = "/lab4_test_int_" + std::to_string(getpid());
+    auto region = SharedFigureRegion<int>::create(name, buffer, 1);
+
+    EXPECT_EQ(region.regionName(), name);
+    ShardedAggregate aggregate = shardedAggregate(region, 1);
+    EXPECT_DOUBLE_EQ(aggregate.centroid.getX(), -0.25);
+    EXPECT_DOUBLE_EQ(aggregate.centroid.getY(), 0.0);
+}
+
+TEST(SharedFiguresTest, OpenByNameSeesSameData) {
+    FigureBuffer<double> buffer = makeCodecBuffer();
+    std::string name = "/lab4_test_open_" + std::to_string(getpid());
+    auto region = SharedFigureRegion<double>::create(name, buffer, 1);
+    auto mapped = SharedFigureRegion<double>::open(name);
+
+    EXPECT_NE(mapped.coords(), region.coords());
+    EXPECT_EQ(std::memcmp(mapped.coords(), buffer.coordData(), buffer.coordCount() * sizeof(double)), 0);
+    EXPECT_THROW(SharedFigureRegion<float>::open(name), std::runtime_error);
+    EXPECT_THROW(SharedFigureRegion<double>::create(name, buffer, 1), std::system_error);
+    EXPECT_THROW(shardedAggregate(region, 2), std::invalid_argument);
+}
+#endif
+
+// Тесты пакетного построения фигур с проверкой
+static void appendFigure(std::vector<FigureKind>& kinds, std::vector<double>& coords, const Figure<double>& figure) {
+    kinds.push_back(static_cast<FigureKind>(figure.vertexCount()));
+    for (size_t v = 0; v < figure.vertexCount(); ++v) {
+        coords.push_back(figure.getVertex(v).getX());
+        coords.push_back(figure.getVertex(v).getY());
+    }
+}
+
+TEST(FigureBatchTest, ValidBatchBuildsAllFigures) {
+    std::vector<FigureKind> kinds;
+    std::vector<double> coords;
+    for (int i = 0; i < 200; ++i) {
+        appendFigure(kinds, coords, Hexagon<double>(Point<double>(i, -i), 1.0 + i % 7));
+        appendFigure(kinds, coords, Pentagon<double>(Point<double>(-i, i), 0.5 + i % 3));
+        appendFigure(kinds, coords, Rhombus<double>(Point<double>(0, 2), Point<double>(3, 0),
+                                                    Point<double>(0, -2), Point<double>(-3, 0)));
+    }
+
+    FigureBatchErrors errors;
+    auto figures = buildFigures(kinds, coords, errors);
+    EXPECT_TRUE(errors.allValid());
+    ASSERT_EQ(figures.size(), kinds.size());
+    EXPECT_DOUBLE_EQ(figures[2]->area(), 12.0);
+
+    FigureBuffer<double> buffer = buildFigureBuffer(kinds.data(), kinds.size(), coords.data(), coords.size(), errors);
+    EXPECT_EQ(buffer.size(), kinds.size());
+    EXPECT_NEAR(buffer.totalArea(), totalArea(figures), 1e-9 * buffer.totalArea());
+}
+
+TEST(FigureBatchTest, ErrorBitmapMarksRejectedFigures) {
+    std::vector<FigureKind> kinds;
+    std::vector<double> coords;
+    appendFigure(kinds, coords, Hexagon<double>(Point<double>(0, 0), 1.0));
+    appendFigure(kinds, coords, Rhombus<double>(Point<double>(0, 0), Point<double>(2, 0),
+                                                Point<double>(3, 1), Point<double>(1, 1)));
+    appendFigure(kinds, coords, Rhombus<double>(Point<double>(0, 0), Point<double>(1, 0),
+                                                Point<double>(1, 0), Point<double>(0, 0)));
+    Hexagon<double> stretched(Point<double>(0, 0), Point<double>(2, 0), Point<double>(3, 1),
+                              Point<double>(2, 2), Point<double>(0, 2), Point<double>(-1, 1));
+    appendFigure(kinds, coords, stretched);
+    appendFigure(kinds, coords, Pentagon<double>(Point<double>(0, 0), 1.0));
+    coords[coords.size() - 1] = std::nan("");
+    appendFigure(kinds, coords, Pentagon<double>(Point<double>(5, 5), 2.0));
+
+    FigureBatchErrors errors = validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size());
+    EXPECT_TRUE(errors.valid(0));
+    EXPECT_TRUE(errors.has(1, FigureError::UnequalSides));
+    EXPECT_TRUE(errors.has(2, FigureError::Degenerate));
+    EXPECT_TRUE(errors.has(3, FigureError::Irregular));
+    EXPECT_TRUE(errors.has(4, FigureError::Degenerate));
+    EXPECT_TRUE(errors.valid(5));
+    EXPECT_EQ(errors.invalidCount(), 4);
+    EXPECT_EQ(errors.bitmap()[0], 0b011110u);
+
+    kinds.push_back(static_cast<FigureKind>(7));
+    kinds.push_back(FigureKind::Rhombus);
+    errors = validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size());
+    EXPECT_TRUE(errors.valid(5));
+    EXPECT_TRUE(errors.has(6, FigureError::UnknownKind));
+    EXPECT_TRUE(errors.has(7, FigureError::Truncated));
+
+    errors = validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size() - 1);
+    EXPECT_TRUE(errors.has(5, FigureError::Truncated));
+    EXPECT_TRUE(errors.has(7, FigureError::Truncated));
+    EXPECT_FALSE(errors.has(6, FigureError::UnknownKind));
+}
+
+TEST(FigureBatchTest, PentagramIsDegenerate) {
+    // Вершины правильного пятиугольника в порядке 0, 2, 4, 1, 3: стороны, радиусы
+    // и повороты одинаковы, но обход самопересекающийся
+    Pentagon<double> pentagon(Point<double>(0, 0), 1.0);
+    std::vector<FigureKind> kinds = {FigureKind::Pentagon, FigureKind::Pentagon};
+    std::vector<double> coords;
+    for (size_t order : {0, 1}) {
+        for (size_t i = 0; i < 5; ++i) {
+            const Point<double>& p = pentagon.getVertex(order == 0 ? 2 * i % 5 : i);
+            coords.push_back(p.getX());
+            coords.push_back(p.getY());
+        }
+    }
+
+    FigureBatchErrors errors = validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size());
+    EXPECT_TRUE(errors.has(0, FigureError::Degenerate));
+    EXPECT_FALSE(errors.has(0, FigureError::Irregular));
+    EXPECT_TRUE(errors.valid(1));
+}
+
+TEST(FigureBatchTest, ReadsBatchFromStream) {
+    std::istringstream input("4  0 1 1 0 0 -1 -1 0\n4  0 0 5 0 5 1 0 1\n6 1 2");
+    std::vector<FigureKind> kinds;
+    std::vector<double> coords;
+    EXPECT_EQ(readFigureBatch(input, kinds, coords), 3);
+
+    FigureBatchErrors errors;
+    auto figures = buildFigures(kinds, coords, errors);
+    ASSERT_EQ(figures.size(), 1);
+    EXPECT_DOUBLE_EQ(figures[0]->area(), 2.0);
+    EXPECT_TRUE(errors.has(1, FigureError::UnequalSides));
+    EXPECT_TRUE(errors.has(2, FigureError::Truncated));
+}
+
+// Сверка быстрых путей с эталонными классами фигур на случайных нагрузках
+static std::vector<WorkloadConfig> differentialConfigs() {
+    WorkloadConfig uniform;
+    uniform.figures = 20000;
+
+    WorkloadConfig rotated = uniform;
+    rotated.seed = 7;
+    rotated.sizes = SizeDistribution::LogUniform;
+    rotated.minRadius = 1e-3;
+    rotated.maxRadius = 1e3;
+    rotated.randomRotation = true;
+
+    WorkloadConfig far = uniform;
+    far.seed = 11;
+    far.coordRange = 1e7;
+    far.sizes = SizeDistribution::Bimodal;
+    far.minRadius = 1.0;
+    far.maxRadius = 100.0;
+    far.randomRotation = true;
+    far.kindWeights = {3.0, 1.0, 1.0};
+
+    WorkloadConfig broken = rotated;
+    broken.seed = 13;
+    broken.degenerateShare = 0.1;
+    return {uniform, rotated, far, broken};
+}
+
+// Эталон площади по вершинам: веер от первой вершины в long double
+static double referenceShoelace(const Figure<double>& figure) {
+    long double x0 = figure.getVertex(0).getX(), y0 = figure.getVertex(0).getY(), sum = 0;
+    for (size_t v = 1; v + 1 < figure.vertexCount(); ++v) {
+        long double dx1 = figure.getVertex(v).getX() - x0, dy1 = figure.getVertex(v).getY() - y0;
+        long double dx2 = figure.getVertex(v + 1).getX() - x0, dy2 = figure.getVertex(v + 1).getY() - y0;
+        sum += dx1 * dy2 - dx2 * dy1;
+    }
+    return static_cast<double>(std::abs(sum) / 2);
+}
+
+TEST(DifferentialTest, PackedEnginesMatchReferenceFigures) {
+    for (const WorkloadConfig& config : differentialConfigs()) {
+        SCOPED_TRACE("seed " + std::to_string(config.seed));
+        auto figures = generateFigures<double>(config);
+        FigureBuffer<double> buffer(figures);
+
+        CompensatedSum reference;
+        for (size_t i = 0; i < figures.size(); ++i) {
+            ASSERT_LE(ulpDistance(buffer.area(i), figures[i]->area()), 4u) << "figure " << i;
+            ASSERT_TRUE(ulpEquals(buffer.geometricCenter(i), figures[i]->geometricCenter(), 4)) << "figure " << i;
+            reference.add(figures[i]->area());
+        }
+        EXPECT_LE(ulpDistance(buffer.totalArea(), reference.value()), figures.size());
+
+        FigureBuffer<double> decoded = decodeFigures<double>(encodeFigures(buffer));
+        ASSERT_EQ(decoded.coordCount(), buffer.coordCount());
+        EXPECT_EQ(std::memcmp(decoded.coordData(), buffer.coordData(), buffer.coordCount() * sizeof(double)), 0);
+
+        FigureAggregator aggregator;
+        for (size_t i = 0; i < figures.size(); ++i) {
+            aggregator.insert(i, *figures[i]);
+        }
+        EXPECT_LE(ulpDistance(aggregator.totalArea(), reference.value()), figures.size());
+
+        auto sorted = figures;
+        sortByArea(sorted);
+        std::vector<double> areas;
+        for (const auto& figure : figures) areas.push_back(figure->area());
+        std::sort(areas.begin(), areas.end());
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            ASSERT_EQ(sorted[i]->area(), areas[i]) << "position " << i;
+        }
+    }
+}
+
+TEST(DifferentialTest, RobustAndBatchPathsMatchReference) {
+    for (const WorkloadConfig& config : differentialConfigs()) {
+        SCOPED_TRACE("seed " + std::to_string(config.seed));
+        std::vector<bool> degenerate;
+        auto figures = generateFigures<double>(config, &degenerate);
+
+        std::vector<FigureKind> kinds;
+        std::vector<double> coords;
+        for (size_t i = 0; i < figures.size(); ++i) {
+            double expected = referenceShoelace(*figures[i]);
+            double area = robustArea(*figures[i]);
+            // Быстрый путь гарантирует относительную погрешность 2^-40, т.е. не более 2^13 ulp
+            if (expected == 0) {
+                ASSERT_EQ(area, 0.0) << "figure " << i;
+            } else {
+                ASSERT_LE(ulpDistance(area, expected), uint64_t(1) << 13) << "figure " << i;
+            }
+            appendFigure(kinds, coords, *figures[i]);
+        }
+
+        FigureBatchErrors errors = validateFigures(kinds.data(), kinds.size(), coords.data(), coords.size());
+        for (size_t i = 0; i < figures.size(); ++i) {
+            ASSERT_EQ(errors.valid(i), !degenerate[i]) << "figure " << i;
+        }
+    }
+}
+
+TEST(DifferentialTest, ParsersRejectMutatedInput) {
+    WorkloadConfig config;
+    config.figures = 300;
+    config.degenerateShare = 0.2;
+    auto figures = generateFigures<double>(config);
+    std::vector<uint8_t> stream = encodeFigures(FigureBuffer<double>(figures));
+
+    std::mt19937 rng(5);
+    for (int round = 0; round < 2000; ++round) {
+        std::vector<uint8_t> mutated = stream;
+        for (int flips = 1 + round % 4; flips > 0; --flips) {
+            mutated[rng() % mutated.size()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+        }
+        mutated.resize(mutated.size() - (round % 3 == 0 ? rng() % mutated.size() : 0));
+        try {
+            FigureBuffer<double> decoded = decodeFigures<double>(mutated);
+            EXPECT_LE(decoded.size(), figures.size() * 4);
+        } catch (const std::exception&) {
+        }
+
+        std::string text;
+        for (int token = 0; token < 20; ++token) {
+            text += std::to_string(static_cast<int>(rng() % 9) - 1) + (rng() % 5 ? " " : "\n");
+        }
+        std::istringstream input(text);
+        std::vector<FigureKind> kinds;
+        std::vector<double> coords;
+        readFigureBatch(input, kinds, coords);
+        FigureBatchErrors errors;
+        auto built = buildFigures(kinds, coords, errors);
+        EXPECT_EQ(built.size() + errors.invalidCount(), kinds.size());
+    }
+}
+
+// Тесты растеризации в сетку покрытия
+static GridSpec makeGridSpec(double minX, double minY, double cellSize, size_t width, size_t height) {
+    GridSpec spec;
+    spec.minX = minX;
+    spec.minY = minY;
+    spec.cellSize = cellSize;
+    spec.width = width;
+    spec.height = height;
+    return spec;
+}
+
+TEST(FigureRasterTest, DiamondCoversHalfOfFourCells) {
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.push_back(std::make_shared<Rhombus<double>>(Point<double>(2, 1), Point<double>(3, 2),
+                                                        Point<double>(2, 3), Point<double>(1, 2)));
+    CoverageGrid grid(makeGridSpec(0, 0, 1, 8, 8));
+    rasterize(figures, grid);
+
+    EXPECT_NEAR(grid.at(1, 1), 0.5, 1e-6);
+    EXPECT_NEAR(grid.at(2, 2), 0.5, 1e-6);
+    EXPECT_NEAR(grid.at(2, 1), 0.5, 1e-6);
+    EXPECT_EQ(grid.at(0, 0), 0.0f);
+    EXPECT_NEAR(grid.total(), 2.0, 1e-6);
+    EXPECT_EQ(grid.allocatedTiles(), 1);
+}
+
+TEST(FigureRasterTest, TotalCoverageMatchesAreaAcrossTiles) {
+    WorkloadConfig config;
+    config.figures = 2000;
+    config.coordRange = 90;
+    config.maxRadius = 8;
+    config.randomRotation = true;
+    auto figures = generateFigures<double>(config);
+
+    // Ячейка 0.25: сетка 800 x 800, фигуры пересекают границы плиток
+    CoverageGrid grid(makeGridSpec(-100, -100, 0.25, 800, 800));
+    rasterize(figures, grid);
+    double expected = 0;
+    for (const auto& figure : figures) expected += robustArea(*figure);
+    EXPECT_NEAR(grid.total() * 0.0625, expected, 1e-5 * expected);
+
+    // Шестиугольник симметричен относительно осей: в сетку попадает четверть
+    Array<std::shared_ptr<Figure<double>>> corner;
+    corner.push_back(std::make_shared<Hexagon<double>>(Point<double>(0, 0), 10.0));
+    CoverageGrid clipped(makeGridSpec(0, 0, 1, 100, 100));
+    rasterize(corner, clipped);
+    EXPECT_NEAR(clipped.total(), corner[0]->area() / 4, 1e-4);
+}
+
+TEST(FigureRasterTest, CellCoverageMatchesSupersampling) {
+    WorkloadConfig config;
+    config.figures = 20;
+    config.coordRange = 6;
+    config.minRadius = 0.5;
+    config.maxRadius = 4;
+    config.randomRotation = true;
+    config.seed = 3;
+    auto figures = generateFigures<double>(config);
+    CoverageGrid grid(makeGridSpec(-10, -10, 1, 20, 20));
+    rasterize(figures, grid);
+    CoverageGrid binary(makeGridSpec(-10, -10, 1, 20, 20));
+    rasterize(figures, binary, RasterMode::Binary);
+
+    auto inside = [](const Figure<double>& figure, double x, double y) {
+        int sign = 0;
+        for (size_t v = 0; v < figure.vertexCount(); ++v) {
+            const Point<double>& p = figure.getVertex(v);
+            const Point<double>& q = figure.getVertex((v + 1) % figure.vertexCount());
+            double c = (q.getX() - p.getX()) * (y - p.getY()) - (q.getY() - p.getY()) * (x - p.getX());
+            int s = c > 0 ? 1 : -1;
+            if (sign != 0 && s != sign) return false;
+            sign = s;
+        }
+        return true;
+    };
+    const int samples = 32;
+    for (size_t cy = 0; cy < 20; ++cy) {
+        for (size_t cx = 0; cx < 20; ++cx) {
+            double x0 = static_cast<double>(cx) - 10, y0 = static_cast<double>(cy) - 10;
+            double reference = 0;
+            int centers = 0;
+            for (const auto& figure : figures) {
+                int hits = 0;
+                for (int sy = 0; sy < samples; ++sy) {
+                    for (int sx = 0; sx < samples; ++sx) {
+                        hits += inside(*figure, x0 + (sx + 0.5) / samples, y0 + (sy + 0.5) / samples);
+                    }
+                }
+                reference += static_cast<double>(hits) / (samples * samples);
+                centers += inside(*figure, x0 + 0.5, y0 + 0.5);
+            }
+            ASSERT_NEAR(grid.at(cx, cy), reference, 0.01) << cx << ", " << cy;
+            ASSERT_EQ(binary.at(cx, cy), static_cast<float>(centers)) << cx << ", " << cy;
+        }
+    }
+}
+
+// Тесты пула фигур
+TEST(FigurePoolTest, ReleasedFigureIsReusedInPlace) {
+    auto& pool = FigurePool<Hexagon<double>>::instance();
+    Hexagon<double> source(Point<double>(1, 2), 3.0);
+
+    auto first = pool.make(source);
+    const Hexagon<double>* address = first.get();
+    const Point<double>* vertex = &first->getVertex(0);
+    EXPECT_TRUE(*first == source);
+    first.reset();
+
+    size_t created = pool.stats().created;
+    auto second = pool.make(Point<double>(0, 0), Point<double>(1, 0), Point<double>(2, 1),
+                            Point<double>(1, 2), Point<double>(0, 2), Point<double>(-1, 1));
+    EXPECT_EQ(second.get(), address);
+    EXPECT_EQ(&second->getVertex(0), vertex);
+    EXPECT_EQ(second->getVertex(2), Point<double>(2, 1));
+    EXPECT_EQ(pool.stats().created, created);
+
+    // Присваивание и чтение тоже не пересоздают вершины
+    std::istringstream input("0 0 1 0 2 0 3 0 4 0 5 0");
+    input >> *second;
+    EXPECT_EQ(&second->getVertex(0), vertex);
+    EXPECT_EQ(second->getVertex(5), Point<double>(5, 0));
+    *second = source;
+    EXPECT_EQ(&second->getVertex(0), vertex);
+    EXPECT_TRUE(*second == source);
+
+    // Число точек в make() проверяется при компиляции, индекс setVertex — при вызове
+    static_assert(Rhombus<double>::VertexCount == 4 && Hexagon<double>::VertexCount == 6, "vertex counts");
+    EXPECT_THROW(second->setVertex(Hexagon<double>::VertexCount, Point<double>(0, 0)), std::out_of_range);
+}
+
+TEST(FigurePoolTest, ThreadExitReturnsObjectsToSharedStack) {
+    auto& pool = FigurePool<Pentagon<double>>::instance();
+    FigurePoolStats before = pool.stats();
+
+    std::thread producer([&]() {
+        std::vector<std::shared_ptr<Pentagon<double>>> live;
+        for (int i = 0; i < 1000; ++i) {
+            live.push_back(pool.make(Pentagon<double>(Point<double>(i, 0), 1.0)));
+        }
+    });
+    producer.join();
+    FigurePoolStats afterProducer = pool.stats();
+    EXPECT_GE(afterProducer.created - before.created, 1000 - pool.localSize());
+    EXPECT_GT(afterProducer.batchesPushed, before.batchesPushed);
+
+    std::vector<std::shared_ptr<Pentagon<double>>> reused;
+    for (int i = 0; i < 1000; ++i) {
+        reused.push_back(pool.make(Point<double>(i, 0), Point<double>(i + 1, 0), Point<double>(i + 1, 1),
+                                   Point<double>(i, 2), Point<double>(i - 1, 1)));
+    }
+    EXPECT_EQ(pool.stats().created, afterProducer.created);
+    EXPECT_GT(pool.stats().batchesTaken, afterProducer.batchesTaken);
+    EXPECT_EQ(reused[999]->getVertex(0), Point<double>(999, 0));
+}
+
+TEST(FigurePoolTest, TrimFreesBlocksLeftByFinishedThreads) {
+    using Cache = BlockCache<sizeof(double) * 5>;
+    Cache::trim();
+    std::thread worker([]() {
+        std::vector<void*> blocks;
+        for (int i = 0; i < 300; ++i) {
+            blocks.push_back(Cache::allocate());
+        }
+        for (void* block : blocks) {
+            Cache::deallocate(block);
+        }
+    });
+    worker.join();
+
+    // Всё, что вернул завершившийся поток, лежит в общем стеке до trim()
+    EXPECT_EQ(Cache::trim(), 300u);
+    EXPECT_EQ(Cache::trim(), 0u);
+
+    auto& pool = FigurePool<Rhombus<double>>::instance();
+    std::thread producer([&]() {
+        auto figure = pool.make(Point<double>(0, 1), Point<double>(1, 0), Point<double>(0, -1), Point<double>(-1, 0));
+    });
+    producer.join();
+    EXPECT_GE(pool.trim(), 1u);
+}
+
+TEST(FigurePoolTest, ConcurrentHandoffKeepsFiguresDistinct) {
+    const size_t threads = 8, perThread = 2000, rounds = 6;
+    std::vector<std::vector<std::shared_ptr<Figure<double>>>> slots[2];
+    slots[0].resize(threads);
+    slots[1].resize(threads);
+    std::atomic<size_t> mismatches{0};
+
+    for (size_t round = 0; round < rounds; ++round) {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t, round]() {
+                // Фигуры соседнего потока прошлого раунда освобождаются здесь
+                slots[(round + 1) % 2][(t + 1) % threads].clear();
+                auto& mine = slots[round % 2][t];
+                for (size_t i = 0; i < perThread; ++i) {
+                    double x = static_cast<double>(t * perThread + i);
+                    double xy[8] = {x, 1, x + 1, 0, x, -1, x - 1, 0};
+                    mine.push_back(makePooledFigure(FigureKind::Rhombus, xy));
+                }
+                for (size_t i = 0; i < perThread; ++i) {
+                    if (mine[i]->getVertex(0).getX() != static_cast<double>(t * perThread + i)) ++mismatches;
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+
+    std::set<const Figure<double>*> distinct;
+    for (const auto& slot : slots[(rounds - 1) % 2]) {
+        for (const auto& figure : slot) distinct.insert(figure.get());
+    }
+    EXPECT_EQ(distinct.size(), threads * perThread);
+
+    FigureBuffer<double> buffer = makeCodecBuffer();
+    auto pooled = toPooledArray(buffer);
+    ASSERT_EQ(pooled.size(), buffer.size());
+    EXPECT_NEAR(totalArea(pooled), buffer.totalArea(), 1e-9 * buffer.totalArea());
+}
+
+// Тесты соединения наборов фигур по центрам
+static CentroidSet makeCentroidGrid(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    // Целые координаты на маленькой сетке: много совпадающих точек и равных расстояний
+    std::uniform_int_distribution<int> coord(0, 40);
+    CentroidSet set;
+    for (size_t i = 0; i < n; ++i) {
+        set.push_back(coord(rng), coord(rng));
+    }
+    return set;
+}
+
+static double centroidDistance2(const CentroidSet& a, size_t i, const CentroidSet& b, size_t j) {
+    double dx = a.x[i] - b.x[j], dy = a.y[i] - b.y[j];
+    return dx * dx + dy * dy;
+}
+
+TEST(FigureJoinTest, KnnMatchesBruteForceWithTies) {
+    CentroidSet left = makeCentroidGrid(700, 1), right = makeCentroidGrid(3000, 2);
+    CentroidTree tree(right);
+    ASSERT_GT(tree.leafCount(), 1u);
+
+    for (size_t k : {size_t(1), size_t(5)}) {
+        auto pairs = knnJoin(left, tree, k);
+        ASSERT_EQ(pairs.size(), left.size() * k);
+        for (size_t i = 0; i < left.size(); ++i) {
+            std::vector<std::pair<double, uint32_t>> expected;
+            for (size_t j = 0; j < right.size(); ++j) {
+                expected.push_back({centroidDistance2(left, i, right, j), static_cast<uint32_t>(j)});
+            }
+            std::partial_sort(expected.begin(), expected.begin() + k, expected.end());
+            for (size_t r = 0; r < k; ++r) {
+                EXPECT_EQ(pairs[i * k + r].left, i);
+                EXPECT_EQ(pairs[i * k + r].right, expected[r].second);
+            }
+        }
+    }
+}
+
+TEST(FigureJoinTest, RadiusJoinMatchesBruteForce) {
+    CentroidSet left = makeCentroidGrid(500, 3), right = makeCentroidGrid(2000, 4);
+    auto pairs = radiusJoin(left, CentroidTree(right), 2.0);
+
+    std::vector<IndexPair> expected;
+    for (size_t i = 0; i < left.size(); ++i) {
+        for (size_t j = 0; j < right.size(); ++j) {
+            if (centroidDistance2(left, i, right, j) <= 4.0) {
+                expected.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j)});
+            }
+        }
+    }
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(pairs, expected);
+    EXPECT_TRUE(radiusJoin(left, CentroidTree(right), -1.0).empty());
+}
+
+TEST(FigureJoinTest, FigureCollectionsJoinOnGeometricCenters) {
+    Array<std::shared_ptr<Figure<double>>> rhombi, hexagons;
+    for (int i = 0; i < 4; ++i) {
+        double x = 10.0 * i;
+        rhombi.push_back(std::make_shared<Rhombus<double>>(Point<double>(x, 1), Point<double>(x + 0.5, 0),
+                                                           Point<double>(x, -1), Point<double>(x - 0.5, 0)));
+    }
+    hexagons.push_back(std::make_shared<Hexagon<double>>(Point<double>(29, 0), 1.0));
+    hexagons.push_back(std::make_shared<Hexagon<double>>(Point<double>(1, 0), 1.0));
+
+    auto nearest = knnJoin(rhombi, hexagons, 1);
+    std::vector<IndexPair> expected = {{0, 1}, {1, 1}, {2, 0}, {3, 0}};
+    EXPECT_EQ(nearest, expected);
+
+    // k больше правого набора: все правые фигуры по возрастанию расстояния
+    auto all = knnJoin(rhombi, hexagons, 10);
+    ASSERT_EQ(all.size(), 8);
+    EXPECT_EQ(all[6].right, 0u);
+    EXPECT_EQ(all[7].right, 1u);
+
+    FigureBuffer<double> left(rhombi), right(hexagons);
+    auto close = radiusJoin(left, right, 1.5);
+    expected = {{0, 1}, {3, 0}};
+    EXPECT_EQ(close, expected);
+    EXPECT_TRUE(knnJoin(left, FigureBuffer<double>(), 3).empty());
+}
+
+// Тесты размещения по узлам NUMA на искусственной топологии
+#ifdef __linux__
+TEST(NumaTest, ParsesCpuListsAndSysfsLayout) {
+    EXPECT_EQ(parseCpuList("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(parseCpuList("").empty());
+
+    namespace fs = std::filesystem;
+    fs::path root = fs::temp_directory_path() / ("lab4_numa_" + std::to_string(getpid()));
+    for (int node : {1, 0}) {
+        fs::path dir = root / ("node" + std::to_string(node));
+        ASSERT_TRUE(fs::create_directories(dir));
+        std::ofstream(dir / "cpulist") << (node == 0 ? "0-1\n" : "2-3\n");
+    }
+    NumaTopology topology = NumaTopology::detect(root.string());
+    ASSERT_GT(fs::remove_all(root), 0u);
+
+    ASSERT_EQ(topology.nodeCount(), 2);
+    EXPECT_EQ(topology.nodeCpus[1], (std::vector<int>{2, 3}));
+    EXPECT_GE(NumaTopology::detect(root.string()).nodeCount(), 1u);
+}
+
+TEST(NumaTest, PartitionedBufferMatchesPlainTotals) {
+    FigureBuffer<double> buffer = makeCodecBuffer();
+    NumaTopology topology = NumaTopology::fake(2, 2);
+    NumaFigureBuffer<double> placed(buffer, topology);
+
+    ASSERT_EQ(placed.size(), buffer.size());
+    EXPECT_EQ(placed.nodeRanges()[0].second % FigureBuffer<double>::OffsetStride, 0);
+    EXPECT_EQ(placed.nodeRanges()[1].second, buffer.size());
+    EXPECT_EQ(std::memcmp(placed.coordData(), buffer.coordData(), buffer.coordCount() * sizeof(double)), 0);
+
+    NumaExecutor executor(topology);
+    NumaRunStats stats;
+    EXPECT_NEAR(placed.totalArea(executor, &stats), buffer.totalArea(), 1e-9 * buffer.totalArea());
+    EXPECT_GT(stats.localChunks + stats.remoteChunks, 0u);
+    EXPECT_NEAR(placed.totalArea(executor, nullptr, 1), buffer.totalArea(), 1e-9 * buffer.totalArea());
+    int node = pageNode(placed.coordData());
+    EXPECT_TRUE(node == -1 || node < static_cast<int>(NumaTopology::detect().nodeCount()));
+}
+
+TEST(NumaTest, ExecutorCoversEveryIndexOnce) {
+    NumaExecutor executor(NumaTopology::fake(3, 2));
+    std::vector<std::atomic<int>> hits(1000);
+    NumaRunStats stats = executor.run({{0, 300}, {300, 301}, {301, 1000}}, 64,
+                                      [&](size_t, size_t begin, size_t end) {
+                                          for (size_t i = begin; i < end; ++i) ++hits[i];
+                                      });
+    for (const auto& hit : hits) {
+        ASSERT_EQ(hit.load(), 1);
+    }
+    EXPECT_EQ(stats.localChunks + stats.remoteChunks, 5 + 1 + 11);
+    EXPECT_THROW(executor.run({{0, 1}}, 64, [](size_t, size_t, size_t) {}), std::invalid_argument);
+}
+#endif
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();